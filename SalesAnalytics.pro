@@ -24,13 +24,98 @@ TEMPLATE = app
 
 CONFIG += c++11
 
+# Отмена выполняющегося запроса. sqlite3_interrupt вызывается по дескриптору
+# драйвера QSQLITE, поэтому нужен тот же SQLite, что у драйвера (Qt, собранный
+# с -system-sqlite); PQcancel берётся из libpq драйвера QPSQL. Без них запрос
+# отменяется между строками результата:
+#   qmake CONFIG+=sqlite_interrupt CONFIG+=pq_cancel
+sqlite_interrupt {
+    DEFINES += HAVE_SQLITE_INTERRUPT
+    LIBS += -lsqlite3
+}
+pq_cancel {
+    DEFINES += HAVE_PQ_CANCEL
+    LIBS += -lpq
+}
+
+# chinook.db копируется в каталог сборки и устанавливается рядом с
+# программой. Если программа лежит в другом каталоге (debug/release),
+# база ищется ещё в рабочем каталоге и в исходниках
+DEFINES += SALESANALYTICS_SOURCE_DIR=\\\"$$PWD\\\"
+CONFIG += file_copies
+COPIES += database
+database.files = chinook.db
+database.path = $$OUT_PWD
+
 SOURCES += \
         main.cpp \
-        mainwindow.cpp
+        mainwindow.cpp \
+        queryexecutor.cpp \
+        reports.cpp \
+        reportcache.cpp \
+        salesrollup.cpp \
+        queryresult.cpp \
+        resulttablemodel.cpp \
+        columnarengine.cpp \
+        aggregatekernels.cpp \
+        partitionedaggregator.cpp \
+        indexadvisor.cpp \
+        statementregistry.cpp \
+        mapscene.cpp \
+        tilemapitem.cpp \
+        markerlayer.cpp \
+        mapprojection.cpp \
+        geocoding.cpp \
+        markerclusters.cpp \
+        salescube.cpp \
+        timecube.cpp \
+        dictionarycodes.cpp \
+        chartupdater.cpp \
+        downsampling.cpp \
+        heavyhitters.cpp \
+        artisttopk.cpp \
+        exportwriters.cpp \
+        batchexport.cpp \
+        tracing.cpp \
+        storageconfig.cpp \
+        sqldialect.cpp \
+        servercursor.cpp \
+        queryinterrupt.cpp
 
 HEADERS += \
         mainwindow.h \
-    zoomablegraphicsview.h
+    zoomablegraphicsview.h \
+    queryexecutor.h \
+    queryresult.h \
+    reports.h \
+    reportcache.h \
+    salesrollup.h \
+    resulttablemodel.h \
+    columnarengine.h \
+    aggregatekernels.h \
+    partitionedaggregator.h \
+    indexadvisor.h \
+    statementregistry.h \
+    mapscene.h \
+    tilemapitem.h \
+    markerlayer.h \
+    mapprojection.h \
+    geocoding.h \
+    markerclusters.h \
+    salescube.h \
+    timecube.h \
+    dictionarycodes.h \
+    chartupdater.h \
+    downsampling.h \
+    heavyhitters.h \
+    artisttopk.h \
+    exportwriters.h \
+    batchexport.h \
+    tracing.h \
+    storageconfig.h \
+    sqldialect.h \
+    servercursor.h \
+    queryinterrupt.h
 
 FORMS += \
         mainwindow.ui
@@ -39,5 +124,9 @@ FORMS += \
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
+databaseinstall.files = chinook.db
+databaseinstall.path = $$target.path
+!isEmpty(target.path): INSTALLS += databaseinstall
 
-RESOURCES +=
+RESOURCES += \
+    resources.qrc
@@ -0,0 +1,28 @@
+#include "aggregatekernels.h"
+
+void AggregateKernels::sumProductByKey(const qint32 *quantity, const double *unitPrice, const quint32 *keys, int count,
+                                       qint64 *rows, qint64 *quantities, double *revenues)
+{
+    // Два цикла, чтобы в цикле без выручки не было проверки на каждой строке
+    if (!unitPrice) {
+        for (int i = 0; i < count; ++i) {
+            quint32 key = keys[i];
+            if (key == SkipKey) {
+                continue;
+            }
+            ++rows[key];
+            quantities[key] += quantity[i];
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        quint32 key = keys[i];
+        if (key == SkipKey) {
+            continue;
+        }
+        ++rows[key];
+        quantities[key] += quantity[i];
+        revenues[key] += quantity[i] * unitPrice[i];
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef AGGREGATEKERNELS_H
+#define AGGREGATEKERNELS_H
+
+#include <QtGlobal>
+
+// Ядро агрегации SUM(Quantity * UnitPrice) ... GROUP BY по плотным кодам
+// групп: один проход по столбцам, суммы копятся прямо в массивах групп.
+// Векторных вариантов нет намеренно: умножение компилятор векторизует
+// сам, а раскладка по группам — это запись по произвольному адресу, и на
+// ключах отчётов (жанры, артисты, страна x жанр) векторные частичные
+// суммы оказались медленнее скалярного цикла (benchmarks/kernelbench)
+namespace AggregateKernels
+{
+
+// Строки с таким кодом группы пропускаются (аналог отброшенных JOIN-ом строк)
+const quint32 SkipKey = 0xFFFFFFFFu;
+
+// Для каждой строки i с keys[i] != SkipKey:
+//   rows[k] += 1; quantities[k] += quantity[i]; revenues[k] += quantity[i] * unitPrice[i]
+// Массивы групп должны вмещать все встречающиеся коды. Если unitPrice
+// равен nullptr, выручка не считается и revenues может быть nullptr
+void sumProductByKey(const qint32 *quantity, const double *unitPrice, const quint32 *keys, int count,
+                     qint64 *rows, qint64 *quantities, double *revenues);
+
+} // namespace AggregateKernels
+
+#endif // AGGREGATEKERNELS_H
@@ -0,0 +1,122 @@
+#include "artisttopk.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+
+namespace
+{
+
+// Те же соединения и фильтры, что в отчёте ArtistsByGenre без параметров
+const char *IncrementSql = R"(
+    SELECT invoice_items.InvoiceId, genres.GenreId, genres.Name, artists.ArtistId, artists.Name,
+           invoice_items.Quantity
+    FROM invoice_items
+    JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+    JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+    JOIN albums ON tracks.AlbumId = albums.AlbumId
+    JOIN artists ON albums.ArtistId = artists.ArtistId
+    JOIN genres ON tracks.GenreId = genres.GenreId
+    WHERE invoice_items.InvoiceId > :after AND invoice_items.InvoiceId <= :upTo
+      AND invoices.InvoiceDate IS NOT NULL)";
+
+struct Entry
+{
+    QString artist;
+    qint64 estimate;
+    qint64 error;
+};
+
+} // namespace
+
+ArtistTopK::ArtistTopK(int capacity, int sketchWidth, int sketchDepth)
+    : capacity(capacity)
+    , sketchWidth(sketchWidth)
+    , sketchDepth(sketchDepth)
+    , lastInvoiceId(0)
+{
+}
+
+void ArtistTopK::clear()
+{
+    genres.clear();
+    artistNames.clear();
+    lastInvoiceId = 0;
+}
+
+bool ArtistTopK::update(QSqlDatabase &db, const DataVersion &version, QString *error)
+{
+    if (version.maxInvoiceId < lastInvoiceId) {
+        clear();
+    }
+    if (version.maxInvoiceId == lastInvoiceId) {
+        return true;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(IncrementSql);
+    query.bindValue(":after", lastInvoiceId);
+    query.bindValue(":upTo", version.maxInvoiceId);
+    if (!query.exec()) {
+        if (error) {
+            *error = query.lastError().text();
+        }
+        return false;
+    }
+
+    while (query.next()) {
+        qint64 genreId = query.value(1).toLongLong();
+        qint64 artistId = query.value(3).toLongLong();
+        qint64 quantity = query.value(5).toLongLong();
+
+        auto genre = genres.find(genreId);
+        if (genre == genres.end()) {
+            genre = genres.insert(genreId, GenreSketch{query.value(2).toString(), SpaceSaving(capacity),
+                                                       CountMinSketch(sketchWidth, sketchDepth)});
+        }
+        if (!artistNames.contains(artistId)) {
+            artistNames.insert(artistId, query.value(4).toString());
+        }
+        genre->counters.add(quint64(artistId), quantity);
+        genre->sketch.add(quint64(artistId), quantity);
+    }
+    // Строк может не быть (счёт без позиций), но диапазон учтён целиком
+    lastInvoiceId = version.maxInvoiceId;
+    return true;
+}
+
+QueryResult ArtistTopK::run(int n) const
+{
+    QVector<QPair<QString, QVector<Entry>>> sorted;
+    sorted.reserve(genres.size());
+    for (const GenreSketch &genre : genres) {
+        QVector<Entry> entries;
+        // Берём все счётчики: после уточнения по Count-Min порядок может измениться
+        for (const SpaceSaving::Counter &counter : genre.counters.top(genre.counters.capacity())) {
+            // Обе оценки не меньше истинной, берём меньшую; нижняя граница —
+            // значение счётчика Space-Saving без унаследованной погрешности
+            qint64 estimate = qMin(counter.count, genre.sketch.estimate(counter.key));
+            qint64 lower = counter.count - counter.error;
+            entries.append({artistNames.value(qint64(counter.key)), estimate, estimate - lower});
+        }
+        int count = qMin(n, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), [](const Entry &a, const Entry &b) {
+            return a.estimate != b.estimate ? a.estimate > b.estimate : a.artist < b.artist;
+        });
+        entries.resize(count);
+        sorted.append(qMakePair(genre.name, entries));
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const QPair<QString, QVector<Entry>> &a,
+                                               const QPair<QString, QVector<Entry>> &b) {
+        return a.first < b.first;
+    });
+
+    QueryResult result;
+    result.columns << "GenreName" << "ArtistName" << "TotalSales" << "MaxError";
+    for (const auto &genre : sorted) {
+        for (const Entry &entry : genre.second) {
+            result.appendRow({genre.first, entry.artist, entry.estimate, entry.error});
+        }
+    }
+    return result;
+}
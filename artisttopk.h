@@ -0,0 +1,49 @@
+#ifndef ARTISTTOPK_H
+#define ARTISTTOPK_H
+
+#include "heavyhitters.h"
+#include "queryresult.h"
+#include "reportcache.h"
+#include <QHash>
+#include <QSqlDatabase>
+#include <QString>
+
+// Приближённый топ артистов по жанрам по проданному количеству. На каждый
+// жанр — Space-Saving на capacity счётчиков и Count-Min; память не зависит
+// от числа артистов и строк продаж. Скетчи досчитываются по счетам с
+// InvoiceId больше уже учтённого, поэтому правки старых счетов видны
+// только в точном режиме (обычный SQL-отчёт)
+class ArtistTopK
+{
+public:
+    explicit ArtistTopK(int capacity = 32, int sketchWidth = 256, int sketchDepth = 4);
+
+    // Учитывает новые счета. Если максимальный InvoiceId уменьшился
+    // (счета удалены), скетчи строятся заново
+    bool update(QSqlDatabase &db, const DataVersion &version, QString *error);
+    void clear();
+
+    // Столбцы как у ArtistsByGenre плюс MaxError: TotalSales — верхняя
+    // оценка, истинное значение не меньше TotalSales - MaxError.
+    // Не больше n артистов на жанр, порядок — жанр, убывание продаж
+    QueryResult run(int n) const;
+
+    qint64 processedInvoiceId() const { return lastInvoiceId; }
+
+private:
+    struct GenreSketch
+    {
+        QString name;
+        SpaceSaving counters;
+        CountMinSketch sketch;
+    };
+
+    int capacity;
+    int sketchWidth;
+    int sketchDepth;
+    qint64 lastInvoiceId;
+    QHash<qint64, GenreSketch> genres;   // GenreId -> скетчи жанра
+    QHash<qint64, QString> artistNames;  // ArtistId -> имя
+};
+
+#endif // ARTISTTOPK_H
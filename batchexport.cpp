@@ -0,0 +1,235 @@
+#include "batchexport.h"
+#include "exportwriters.h"
+#include "reports.h"
+#include "servercursor.h"
+#include "tracing.h"
+#include "statementregistry.h"
+#include "storageconfig.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTextStream>
+#include <cstring>
+
+namespace
+{
+
+const char *ConnectionName = "batch-export";
+
+// Отчёт целиком в открытой БД; false с текстом ошибки в *error.
+// fetchSize > 0 — строки читаются порциями через курсор PostgreSQL
+bool exportReport(QSqlDatabase &db, const ReportDefinition &report, const QVariantMap &params, int fetchSize,
+                  ExportWriter *writer, qint64 *rowCount, QString *error)
+{
+    StatementRegistry statements;
+    ServerCursor cursor(db, "export_cursor");
+    QSqlQuery query(db);
+    {
+        TRACE_SCOPE_CATEGORY("exec", "export");
+        if (fetchSize > 0) {
+            QString sql = Dialect::inlineParams(db, report.sql, params, Reports::defaultParams());
+            if (!cursor.open(sql, error) || !cursor.fetch(fetchSize, &query, error)) {
+                return false;
+            }
+        } else if (!statements.prepare(db, report.name, report.sql, error)) {
+            return false;
+        } else if (!statements.exec(report.name, params, Reports::defaultParams(), &query)) {
+            *error = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Следующая строка; после полной порции курсора запрашивается следующая.
+    // Ошибка выборки остаётся в query.lastError()
+    int batchRows = 0;
+    auto next = [&]() -> bool {
+        while (!query.next()) {
+            QString fetchError;
+            if (!cursor.isOpen() || batchRows < fetchSize || !cursor.fetch(fetchSize, &query, &fetchError)) {
+                return false;
+            }
+            batchRows = 0;
+        }
+        ++batchRows;
+        return true;
+    };
+    TRACE_SCOPE_CATEGORY("write", "export");
+
+    QSqlRecord record = query.record();
+    int columnCount = record.count();
+    QStringList columns;
+    for (int col = 0; col < columnCount; ++col) {
+        columns << record.fieldName(col);
+    }
+
+    // Типы столбцов нужны до первой строки (схема Arrow) и берутся из
+    // описания результата. Только если драйвер тип не сообщил, он
+    // определяется по первой строке
+    bool hasRow = next();
+    QVector<QVariant::Type> types;
+    for (int col = 0; col < columnCount; ++col) {
+        QVariant::Type type = record.field(col).type();
+        if (type == QVariant::Invalid && hasRow && !query.value(col).isNull()) {
+            type = query.value(col).type();
+        }
+        types << type;
+    }
+    if (!writer->begin(columns, types)) {
+        *error = writer->errorString();
+        return false;
+    }
+
+    QVector<QVariant> values(columnCount);
+    *rowCount = 0;
+    for (; hasRow; hasRow = next()) {
+        for (int col = 0; col < columnCount; ++col) {
+            values[col] = query.value(col);
+        }
+        if (!writer->writeRow(values)) {
+            *error = writer->errorString();
+            return false;
+        }
+        ++*rowCount;
+    }
+    if (query.lastError().isValid()) {
+        *error = query.lastError().text();
+        return false;
+    }
+    if (!writer->finish()) {
+        *error = writer->errorString();
+        return false;
+    }
+    Tracing::counter("rows", *rowCount);
+    return true;
+}
+
+} // namespace
+
+bool BatchExport::requested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--report") == 0 || std::strncmp(argv[i], "--report=", 9) == 0
+                || std::strcmp(argv[i], "--list-reports") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int BatchExport::run(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Выгрузка отчёта в CSV или Arrow IPC без окна");
+    parser.addHelpOption();
+    QCommandLineOption reportOption("report", "Имя отчёта.", "name");
+    QCommandLineOption outOption("out", "Файл результата; \"-\" или без ключа — стандартный вывод.", "file");
+    QCommandLineOption formatOption("format", "csv или arrow; по умолчанию по расширению файла.", "format");
+    QCommandLineOption paramOption("param", "Параметр отчёта, например country=USA.", "name=value");
+    QCommandLineOption listOption("list-reports", "Показать имена отчётов.");
+    QCommandLineOption traceOption("trace", "Записать трассу выгрузки в формате Chrome trace.", "file");
+    parser.addOptions({reportOption, outOption, formatOption, paramOption, listOption, traceOption});
+    StorageConfig::addOptions(&parser);
+    parser.process(arguments);
+
+    if (parser.isSet(listOption)) {
+        for (const ReportDefinition &report : Reports::all()) {
+            out << report.name << endl;
+        }
+        return 0;
+    }
+
+    ReportId id;
+    if (!Reports::findByName(parser.value(reportOption), &id)) {
+        err << "Unknown report: " << parser.value(reportOption) << " (see --list-reports)" << endl;
+        return 2;
+    }
+
+    // Значения параметров — строки; числа передаются как целые, иначе
+    // SQLite не примет их, например, в LIMIT
+    QVariantMap params;
+    for (const QString &param : parser.values(paramOption)) {
+        int separator = param.indexOf('=');
+        if (separator <= 0) {
+            err << "Invalid parameter: " << param << endl;
+            return 2;
+        }
+        QString value = param.mid(separator + 1);
+        bool isNumber = false;
+        qint64 number = value.toLongLong(&isNumber);
+        params.insert(":" + param.left(separator), isNumber ? QVariant(number) : QVariant(value));
+    }
+
+    QString fileName = parser.value(outOption);
+    QString format = parser.value(formatOption).toLower();
+    if (format.isEmpty()) {
+        QString suffix = QFileInfo(fileName).suffix().toLower();
+        format = (suffix == "arrow" || suffix == "arrows" || suffix == "ipc") ? "arrow" : "csv";
+    }
+    if (format != "csv" && format != "arrow") {
+        err << "Unknown format: " << format << endl;
+        return 2;
+    }
+
+    QFile file;
+    bool opened;
+    if (fileName.isEmpty() || fileName == "-") {
+        opened = file.open(stdout, QIODevice::WriteOnly);
+    } else {
+        file.setFileName(fileName);
+        opened = file.open(QIODevice::WriteOnly);
+    }
+    if (!opened) {
+        err << "Cannot open " << fileName << ": " << file.errorString() << endl;
+        return 1;
+    }
+
+    QScopedPointer<ExportWriter> writer;
+    if (format == "arrow") {
+        writer.reset(new ArrowStreamWriter(&file));
+    } else {
+        writer.reset(new CsvWriter(&file));
+    }
+
+    Tracing::setEnabled(parser.isSet(traceOption));
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    qint64 rowCount = 0;
+    bool ok;
+    {
+        // Выгрузка ничего не пишет в базу
+        StorageConfig storage = StorageConfig::fromParser(parser);
+        storage.readOnly = true;
+        QSqlDatabase db = storage.open(ConnectionName, &error);
+        ok = db.isOpen();
+        if (ok) {
+            int fetchSize = storage.dialect == SqlDialect::Postgres ? storage.fetchSize : 0;
+            ok = exportReport(db, Reports::definition(id, storage.dialect), params, fetchSize, writer.data(),
+                              &rowCount, &error);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(ConnectionName);
+    Tracing::counter("bytes", file.pos());
+    file.close();
+
+    if (parser.isSet(traceOption) && !Tracing::exportChromeTrace(parser.value(traceOption), &error)) {
+        err << "Cannot write trace: " << error << endl;
+    }
+
+    if (!ok) {
+        err << "Export failed: " << error << endl;
+        return 1;
+    }
+    err << rowCount << " rows in " << timer.elapsed() << " ms" << endl;
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+#include <QStringList>
+
+// Пакетный режим без окна:
+//   SalesAnalytics --report <имя> --out <файл> [--format csv|arrow]
+//                  [--param имя=значение]... [ключи хранилища, см. StorageConfig]
+// Отчёты те же, что в окне; строки пишутся прямо из курсора запроса
+namespace BatchExport
+{
+    // В командной строке есть ключи пакетного режима
+    bool requested(int argc, char *argv[]);
+
+    // Выполняет отчёт; возвращает код завершения процесса. Нужен
+    // QCoreApplication
+    int run(const QStringList &arguments);
+}
+
+#endif // BATCHEXPORT_H
@@ -0,0 +1,11 @@
+# Все инструменты замеров одной сборкой:
+#   qmake benchmarks.pro && make
+# kernelbench — ядра агрегации, datagen — синтетические базы,
+# reportbench — отчёты на базах datagen
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    kernelbench \
+    datagen \
+    reportbench
@@ -0,0 +1,16 @@
+#-------------------------------------------------
+#
+# Генератор синтетических баз в схеме chinook
+#
+#-------------------------------------------------
+
+QT       += core sql
+QT       -= gui
+
+TARGET = datagen
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
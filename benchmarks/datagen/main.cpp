@@ -0,0 +1,591 @@
+// Генератор синтетических баз в схеме chinook для нагрузочных замеров:
+//   datagen --out big.db --items 10000000 [--seed 1] [--years 5]
+// Распределения приближены к реальным продажам: популярность артистов и
+// жанров по Ципфу, сезонность по месяцам, страны покупателей — как в chinook.
+// При одной затравке база получается одной и той же при любой сборке
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const char *Schema[] = {
+    R"(CREATE TABLE "artists"
+    (
+        [ArtistId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [Name] NVARCHAR(120)
+    ))",
+    R"(CREATE TABLE "albums"
+    (
+        [AlbumId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [Title] NVARCHAR(160)  NOT NULL,
+        [ArtistId] INTEGER  NOT NULL,
+        FOREIGN KEY ([ArtistId]) REFERENCES "artists" ([ArtistId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))",
+    R"(CREATE TABLE "employees"
+    (
+        [EmployeeId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [LastName] NVARCHAR(20)  NOT NULL,
+        [FirstName] NVARCHAR(20)  NOT NULL,
+        [Title] NVARCHAR(30),
+        [ReportsTo] INTEGER,
+        [BirthDate] DATETIME,
+        [HireDate] DATETIME,
+        [Address] NVARCHAR(70),
+        [City] NVARCHAR(40),
+        [State] NVARCHAR(40),
+        [Country] NVARCHAR(40),
+        [PostalCode] NVARCHAR(10),
+        [Phone] NVARCHAR(24),
+        [Fax] NVARCHAR(24),
+        [Email] NVARCHAR(60),
+        FOREIGN KEY ([ReportsTo]) REFERENCES "employees" ([EmployeeId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))",
+    R"(CREATE TABLE "customers"
+    (
+        [CustomerId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [FirstName] NVARCHAR(40)  NOT NULL,
+        [LastName] NVARCHAR(20)  NOT NULL,
+        [Company] NVARCHAR(80),
+        [Address] NVARCHAR(70),
+        [City] NVARCHAR(40),
+        [State] NVARCHAR(40),
+        [Country] NVARCHAR(40),
+        [PostalCode] NVARCHAR(10),
+        [Phone] NVARCHAR(24),
+        [Fax] NVARCHAR(24),
+        [Email] NVARCHAR(60)  NOT NULL,
+        [SupportRepId] INTEGER,
+        FOREIGN KEY ([SupportRepId]) REFERENCES "employees" ([EmployeeId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))",
+    R"(CREATE TABLE "genres"
+    (
+        [GenreId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [Name] NVARCHAR(120)
+    ))",
+    R"(CREATE TABLE "media_types"
+    (
+        [MediaTypeId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [Name] NVARCHAR(120)
+    ))",
+    R"(CREATE TABLE "tracks"
+    (
+        [TrackId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [Name] NVARCHAR(200)  NOT NULL,
+        [AlbumId] INTEGER,
+        [MediaTypeId] INTEGER  NOT NULL,
+        [GenreId] INTEGER,
+        [Composer] NVARCHAR(220),
+        [Milliseconds] INTEGER  NOT NULL,
+        [Bytes] INTEGER,
+        [UnitPrice] NUMERIC(10,2)  NOT NULL,
+        FOREIGN KEY ([AlbumId]) REFERENCES "albums" ([AlbumId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION,
+        FOREIGN KEY ([GenreId]) REFERENCES "genres" ([GenreId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION,
+        FOREIGN KEY ([MediaTypeId]) REFERENCES "media_types" ([MediaTypeId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))",
+    R"(CREATE TABLE "invoices"
+    (
+        [InvoiceId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [CustomerId] INTEGER  NOT NULL,
+        [InvoiceDate] DATETIME  NOT NULL,
+        [BillingAddress] NVARCHAR(70),
+        [BillingCity] NVARCHAR(40),
+        [BillingState] NVARCHAR(40),
+        [BillingCountry] NVARCHAR(40),
+        [BillingPostalCode] NVARCHAR(10),
+        [Total] NUMERIC(10,2)  NOT NULL,
+        FOREIGN KEY ([CustomerId]) REFERENCES "customers" ([CustomerId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))",
+    R"(CREATE TABLE "invoice_items"
+    (
+        [InvoiceLineId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [InvoiceId] INTEGER  NOT NULL,
+        [TrackId] INTEGER  NOT NULL,
+        [UnitPrice] NUMERIC(10,2)  NOT NULL,
+        [Quantity] INTEGER  NOT NULL,
+        FOREIGN KEY ([InvoiceId]) REFERENCES "invoices" ([InvoiceId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION,
+        FOREIGN KEY ([TrackId]) REFERENCES "tracks" ([TrackId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))",
+    R"(CREATE TABLE "playlists"
+    (
+        [PlaylistId] INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,
+        [Name] NVARCHAR(120)
+    ))",
+    R"(CREATE TABLE "playlist_track"
+    (
+        [PlaylistId] INTEGER  NOT NULL,
+        [TrackId] INTEGER  NOT NULL,
+        CONSTRAINT [PK_PlaylistTrack] PRIMARY KEY  ([PlaylistId], [TrackId]),
+        FOREIGN KEY ([PlaylistId]) REFERENCES "playlists" ([PlaylistId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION,
+        FOREIGN KEY ([TrackId]) REFERENCES "tracks" ([TrackId])
+            ON DELETE NO ACTION ON UPDATE NO ACTION
+    ))"
+};
+
+// Индексы chinook по внешним ключам; создаются после загрузки
+const char *Indexes[] = {
+    "CREATE INDEX [IFK_AlbumArtistId] ON \"albums\" ([ArtistId])",
+    "CREATE INDEX [IFK_CustomerSupportRepId] ON \"customers\" ([SupportRepId])",
+    "CREATE INDEX [IFK_EmployeeReportsTo] ON \"employees\" ([ReportsTo])",
+    "CREATE INDEX [IFK_InvoiceCustomerId] ON \"invoices\" ([CustomerId])",
+    "CREATE INDEX [IFK_InvoiceLineInvoiceId] ON \"invoice_items\" ([InvoiceId])",
+    "CREATE INDEX [IFK_InvoiceLineTrackId] ON \"invoice_items\" ([TrackId])",
+    "CREATE INDEX [IFK_PlaylistTrackTrackId] ON \"playlist_track\" ([TrackId])",
+    "CREATE INDEX [IFK_TrackAlbumId] ON \"tracks\" ([AlbumId])",
+    "CREATE INDEX [IFK_TrackGenreId] ON \"tracks\" ([GenreId])",
+    "CREATE INDEX [IFK_TrackMediaTypeId] ON \"tracks\" ([MediaTypeId])"
+};
+
+// Жанры chinook по убыванию популярности; видео продаётся дороже
+struct GenreInfo
+{
+    const char *name;
+    bool video;
+};
+
+const GenreInfo Genres[] = {
+    {"Rock", false}, {"Latin", false}, {"Metal", false}, {"Alternative & Punk", false}, {"Jazz", false},
+    {"Blues", false}, {"TV Shows", true}, {"Classical", false}, {"R&B/Soul", false}, {"Reggae", false},
+    {"Drama", true}, {"Pop", false}, {"Sci Fi & Fantasy", true}, {"Soundtrack", false},
+    {"Hip Hop/Rap", false}, {"Bossa Nova", false}, {"Alternative", false}, {"World", false},
+    {"Electronica/Dance", false}, {"Heavy Metal", false}, {"Easy Listening", false}, {"Comedy", true},
+    {"Rock And Roll", false}, {"Science Fiction", true}, {"Opera", false}
+};
+
+const char *MediaTypes[] = {
+    "MPEG audio file", "Protected AAC audio file", "Protected MPEG-4 video file",
+    "Purchased AAC audio file", "AAC audio file"
+};
+const int VideoMediaType = 3;
+const int AudioMediaTypes[] = {1, 2, 4, 5};
+
+// Страны и города покупателей chinook; вес — число покупателей
+struct CountryInfo
+{
+    const char *country;
+    int weight;
+    QStringList cities;
+};
+
+QVector<CountryInfo> countries()
+{
+    return {
+        {"USA", 13, {"Boston", "Chicago", "Cupertino", "Fort Worth", "Madison", "Mountain View", "New York",
+                     "Orlando", "Redmond", "Reno", "Salt Lake City", "Tucson"}},
+        {"Canada", 8, {"Edmonton", "Halifax", "Montréal", "Ottawa", "Toronto", "Vancouver", "Winnipeg",
+                       "Yellowknife"}},
+        {"France", 5, {"Bordeaux", "Dijon", "Lyon", "Paris"}},
+        {"Brazil", 5, {"Brasília", "Rio de Janeiro", "São José dos Campos", "São Paulo"}},
+        {"Germany", 4, {"Berlin", "Frankfurt", "Stuttgart"}},
+        {"United Kingdom", 3, {"Edinburgh", "London"}},
+        {"Portugal", 2, {"Lisbon", "Porto"}},
+        {"India", 2, {"Bangalore", "Delhi"}},
+        {"Czech Republic", 2, {"Prague"}},
+        {"Sweden", 1, {"Stockholm"}}, {"Spain", 1, {"Madrid"}}, {"Poland", 1, {"Warsaw"}},
+        {"Norway", 1, {"Oslo"}}, {"Netherlands", 1, {"Amsterdam"}}, {"Italy", 1, {"Rome"}},
+        {"Ireland", 1, {"Dublin"}}, {"Hungary", 1, {"Budapest"}}, {"Finland", 1, {"Helsinki"}},
+        {"Denmark", 1, {"Copenhagen"}}, {"Chile", 1, {"Santiago"}}, {"Belgium", 1, {"Brussels"}},
+        {"Austria", 1, {"Vienne"}}, {"Australia", 1, {"Sidney"}}, {"Argentina", 1, {"Buenos Aires"}}
+    };
+}
+
+// Относительные продажи по месяцам: провал летом, пик перед Новым годом
+const double MonthWeights[12] = {0.85, 0.8, 0.9, 0.95, 0.95, 0.85, 0.8, 0.85, 0.95, 1.0, 1.2, 1.6};
+
+const char *FirstNames[] = {"Anna", "Luis", "Leonie", "François", "Bjørn", "Jan", "Helena", "Astrid",
+                            "Daan", "Kara", "Eduardo", "Alexandre", "Roberto", "Fernanda", "Mark",
+                            "Jennifer", "Frank", "Jack", "Michelle", "Tim", "Dan", "Kathy", "Heather"};
+const char *LastNames[] = {"Gonçalves", "Köhler", "Tremblay", "Hansen", "Novák", "Holý", "Gruber",
+                           "Peeters", "Nielsen", "Martins", "Rocha", "Almeida", "Brooks", "Peterson",
+                           "Harris", "Smith", "Miller", "Goyer", "Mitchell", "Johnson", "Stevens"};
+
+// Случайные величины по mt19937_64 без std::*_distribution: последовательность
+// mt19937_64 задана стандартом, а алгоритмы распределений — нет и различаются
+// между стандартными библиотеками
+class Random
+{
+public:
+    explicit Random(quint64 seed) : engine(seed) {}
+
+    // Равномерно в [0, 1), 53 старших бита
+    double unit() { return double(engine() >> 11) / 9007199254740992.0; }
+
+    // Равномерно в [low, high]
+    int uniform(int low, int high) { return low + qMin(int(unit() * (high - low + 1)), high - low); }
+
+private:
+    std::mt19937_64 engine;
+};
+
+// Номер с вероятностью, пропорциональной весу: двоичный поиск по
+// накопленным суммам
+class WeightedChoice
+{
+public:
+    explicit WeightedChoice(const std::vector<double> &weights)
+    {
+        double sum = 0.0;
+        for (double weight : weights) {
+            sum += weight;
+            cumulative.push_back(sum);
+        }
+    }
+
+    int operator()(Random &random) const
+    {
+        double target = random.unit() * cumulative.back();
+        int index = int(std::upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin());
+        return qMin(index, int(cumulative.size()) - 1);
+    }
+
+private:
+    std::vector<double> cumulative;
+};
+
+// Веса Ципфа 1 / k^s для рангов 1..n
+WeightedChoice zipf(int n, double exponent)
+{
+    std::vector<double> weights(n);
+    for (int k = 0; k < n; ++k) {
+        weights[k] = 1.0 / std::pow(k + 1.0, exponent);
+    }
+    return WeightedChoice(weights);
+}
+
+class Generator
+{
+public:
+    Generator(QSqlDatabase &db, qint64 items, int years, quint64 seed)
+        : db(db)
+        , items(items)
+        , years(years)
+        , random(seed)
+        , pendingRows(0)
+    {
+        // Справочники растут с объёмом продаж, но не меньше, чем в chinook
+        artistCount = int(qBound<qint64>(275, items / 400, 100000));
+        customerCount = int(qBound<qint64>(59, items / 38, 2000000));
+    }
+
+    bool run(QString *error)
+    {
+        QSqlQuery query(db);
+        for (const char *pragma : {"PRAGMA journal_mode=OFF", "PRAGMA synchronous=OFF",
+                                   "PRAGMA cache_size=-262144"}) {
+            query.exec(pragma);
+        }
+        for (const char *statement : Schema) {
+            if (!query.exec(statement)) {
+                *error = query.lastError().text();
+                return false;
+            }
+        }
+        if (!generateDimensions(error) || !generateSales(error)) {
+            return false;
+        }
+        for (const char *statement : Indexes) {
+            if (!query.exec(statement)) {
+                *error = query.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Каждые BatchRows строк — отдельная транзакция
+    static const int BatchRows = 200000;
+
+    bool exec(QSqlQuery &query, QString *error)
+    {
+        if (!query.exec()) {
+            *error = query.lastError().text();
+            return false;
+        }
+        if (++pendingRows >= BatchRows) {
+            pendingRows = 0;
+            db.commit();
+            db.transaction();
+        }
+        return true;
+    }
+
+    bool generateDimensions(QString *error)
+    {
+        db.transaction();
+        pendingRows = 0;
+        QSqlQuery query(db);
+
+        query.prepare("INSERT INTO genres (GenreId, Name) VALUES (?, ?)");
+        for (int i = 0; i < int(sizeof(Genres) / sizeof(Genres[0])); ++i) {
+            query.bindValue(0, i + 1);
+            query.bindValue(1, QString::fromUtf8(Genres[i].name));
+            if (!exec(query, error)) {
+                return false;
+            }
+        }
+        query.prepare("INSERT INTO media_types (MediaTypeId, Name) VALUES (?, ?)");
+        for (int i = 0; i < int(sizeof(MediaTypes) / sizeof(MediaTypes[0])); ++i) {
+            query.bindValue(0, i + 1);
+            query.bindValue(1, QString::fromUtf8(MediaTypes[i]));
+            if (!exec(query, error)) {
+                return false;
+            }
+        }
+
+        // Артист — один жанр, 1–3 альбома по 8–14 треков. Треки артиста
+        // идут подряд, поэтому трек выбирается по диапазону артиста
+        WeightedChoice genreOf = zipf(int(sizeof(Genres) / sizeof(Genres[0])), 1.0);
+
+        QSqlQuery artistQuery(db);
+        artistQuery.prepare("INSERT INTO artists (ArtistId, Name) VALUES (?, ?)");
+        QSqlQuery albumQuery(db);
+        albumQuery.prepare("INSERT INTO albums (AlbumId, Title, ArtistId) VALUES (?, ?, ?)");
+        QSqlQuery trackQuery(db);
+        trackQuery.prepare("INSERT INTO tracks (TrackId, Name, AlbumId, MediaTypeId, GenreId, Composer, "
+                           "Milliseconds, Bytes, UnitPrice) VALUES (?, ?, ?, ?, ?, NULL, ?, ?, ?)");
+
+        int albumId = 0;
+        int trackId = 0;
+        firstTrack.resize(artistCount + 1);
+        trackPrices.clear();
+        trackPrices.append(0.0);
+        for (int artist = 0; artist < artistCount; ++artist) {
+            artistQuery.bindValue(0, artist + 1);
+            artistQuery.bindValue(1, QString("Artist %1").arg(artist + 1));
+            if (!exec(artistQuery, error)) {
+                return false;
+            }
+
+            int genre = genreOf(random);
+            bool video = Genres[genre].video;
+            double price = video ? 1.99 : 0.99;
+            firstTrack[artist] = trackId + 1;
+            for (int album = random.uniform(1, 3); album > 0; --album) {
+                ++albumId;
+                albumQuery.bindValue(0, albumId);
+                albumQuery.bindValue(1, QString("Album %1").arg(albumId));
+                albumQuery.bindValue(2, artist + 1);
+                if (!exec(albumQuery, error)) {
+                    return false;
+                }
+                for (int track = random.uniform(8, 14); track > 0; --track) {
+                    ++trackId;
+                    int milliseconds = random.uniform(120000, 420000);
+                    int media = video ? VideoMediaType : AudioMediaTypes[random.uniform(0, 3)];
+                    trackQuery.bindValue(0, trackId);
+                    trackQuery.bindValue(1, QString("Track %1").arg(trackId));
+                    trackQuery.bindValue(2, albumId);
+                    trackQuery.bindValue(3, media);
+                    trackQuery.bindValue(4, genre + 1);
+                    trackQuery.bindValue(5, milliseconds);
+                    trackQuery.bindValue(6, qint64(milliseconds) * 32);
+                    trackQuery.bindValue(7, price);
+                    if (!exec(trackQuery, error)) {
+                        return false;
+                    }
+                    trackPrices.append(price);
+                }
+            }
+        }
+        firstTrack[artistCount] = trackId + 1;
+
+        query.exec("INSERT INTO employees (EmployeeId, LastName, FirstName, Title, Country) "
+                   "VALUES (1, 'Adams', 'Andrew', 'General Manager', 'Canada')");
+
+        // Покупатели по странам с весами chinook
+        customerCountries.clear();
+        customerCities.clear();
+        QVector<CountryInfo> countryList = countries();
+        std::vector<double> weights;
+        for (const CountryInfo &country : countryList) {
+            weights.push_back(country.weight);
+        }
+        WeightedChoice countryOf(weights);
+        const int firstNameCount = int(sizeof(FirstNames) / sizeof(FirstNames[0]));
+        const int lastNameCount = int(sizeof(LastNames) / sizeof(LastNames[0]));
+
+        QSqlQuery customerQuery(db);
+        customerQuery.prepare("INSERT INTO customers (CustomerId, FirstName, LastName, City, Country, Email, "
+                              "SupportRepId) VALUES (?, ?, ?, ?, ?, ?, 1)");
+        for (int customer = 1; customer <= customerCount; ++customer) {
+            const CountryInfo &country = countryList[countryOf(random)];
+            QString city = country.cities[random.uniform(0, country.cities.size() - 1)];
+            customerCountries.append(QString::fromUtf8(country.country));
+            customerCities.append(city);
+            customerQuery.bindValue(0, customer);
+            customerQuery.bindValue(1, QString::fromUtf8(FirstNames[random.uniform(0, firstNameCount - 1)]));
+            customerQuery.bindValue(2, QString::fromUtf8(LastNames[random.uniform(0, lastNameCount - 1)]));
+            customerQuery.bindValue(3, city);
+            customerQuery.bindValue(4, customerCountries.last());
+            customerQuery.bindValue(5, QString("customer%1@example.com").arg(customer));
+            if (!exec(customerQuery, error)) {
+                return false;
+            }
+        }
+        return db.commit();
+    }
+
+    bool generateSales(QString *error)
+    {
+        db.transaction();
+        pendingRows = 0;
+
+        // Счета распределяются по дням пропорционально весу месяца; номера
+        // счетов растут вместе с датой, как при дозаписи
+        QDate first(2009, 1, 1);
+        QDate last = first.addYears(years).addDays(-1);
+        double totalWeight = 0.0;
+        for (QDate day = first; day <= last; day = day.addDays(1)) {
+            totalWeight += MonthWeights[day.month() - 1];
+        }
+        // В среднем пять строк на счёт, как в chinook
+        const int linesPerInvoice = 5;
+        qint64 invoiceCount = qMax<qint64>(1, items / linesPerInvoice);
+
+        WeightedChoice artistOf = zipf(artistCount, 1.07);
+
+        QSqlQuery invoiceQuery(db);
+        invoiceQuery.prepare("INSERT INTO invoices (InvoiceId, CustomerId, InvoiceDate, BillingCity, "
+                             "BillingCountry, Total) VALUES (?, ?, ?, ?, ?, ?)");
+        QSqlQuery itemQuery(db);
+        itemQuery.prepare("INSERT INTO invoice_items (InvoiceLineId, InvoiceId, TrackId, UnitPrice, Quantity) "
+                          "VALUES (?, ?, ?, ?, ?)");
+
+        QTextStream err(stderr);
+        qint64 invoiceId = 0;
+        qint64 lineId = 0;
+        double carry = 0.0;
+        for (QDate day = first; day <= last && lineId < items; day = day.addDays(1)) {
+            carry += invoiceCount * MonthWeights[day.month() - 1] / totalWeight;
+            QString date = day.toString("yyyy-MM-dd 00:00:00");
+            // Последний день забирает остаток строк
+            bool lastDay = day == last;
+            for (; (carry >= 1.0 || lastDay) && lineId < items; carry -= 1.0) {
+                ++invoiceId;
+                int customer = random.uniform(0, customerCount - 1);
+                double total = 0.0;
+                for (int line = random.uniform(1, 2 * linesPerInvoice - 1); line > 0 && lineId < items; --line) {
+                    int artist = artistOf(random);
+                    int tracks = firstTrack[artist + 1] - firstTrack[artist];
+                    int track = firstTrack[artist] + int(random.unit() * tracks);
+                    int quantity = random.unit() < 0.95 ? 1 : 2;
+                    double price = trackPrices[track];
+                    total += price * quantity;
+
+                    ++lineId;
+                    itemQuery.bindValue(0, lineId);
+                    itemQuery.bindValue(1, invoiceId);
+                    itemQuery.bindValue(2, track);
+                    itemQuery.bindValue(3, price);
+                    itemQuery.bindValue(4, quantity);
+                    if (!exec(itemQuery, error)) {
+                        return false;
+                    }
+                    if (lineId % 1000000 == 0) {
+                        err << lineId << " / " << items << " line items" << endl;
+                    }
+                }
+                invoiceQuery.bindValue(0, invoiceId);
+                invoiceQuery.bindValue(1, customer + 1);
+                invoiceQuery.bindValue(2, date);
+                invoiceQuery.bindValue(3, customerCities[customer]);
+                invoiceQuery.bindValue(4, customerCountries[customer]);
+                invoiceQuery.bindValue(5, qRound(total * 100) / 100.0);
+                if (!exec(invoiceQuery, error)) {
+                    return false;
+                }
+            }
+        }
+        err << invoiceId << " invoices, " << lineId << " line items" << endl;
+        return db.commit();
+    }
+
+    QSqlDatabase &db;
+    qint64 items;
+    int years;
+    Random random;
+    int artistCount;
+    int customerCount;
+    int pendingRows;
+    QVector<int> firstTrack;      // артист -> первый трек; последний элемент — граница
+    QVector<double> trackPrices;  // TrackId -> цена
+    QStringList customerCountries;
+    QStringList customerCities;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Генерация базы в схеме chinook заданного объёма");
+    parser.addHelpOption();
+    QCommandLineOption outOption("out", "Файл новой базы.", "file");
+    QCommandLineOption itemsOption("items", "Число строк invoice_items (10^5..10^8).", "count", "100000");
+    QCommandLineOption yearsOption("years", "Число лет продаж, начиная с 2009.", "years", "5");
+    QCommandLineOption seedOption("seed", "Затравка генератора.", "seed", "1");
+    QCommandLineOption forceOption("force", "Перезаписать существующий файл.");
+    parser.addOptions({outOption, itemsOption, yearsOption, seedOption, forceOption});
+    parser.process(app);
+
+    QString fileName = parser.value(outOption);
+    qint64 items = parser.value(itemsOption).toLongLong();
+    int years = parser.value(yearsOption).toInt();
+    if (fileName.isEmpty() || items <= 0 || years <= 0) {
+        parser.showHelp(2);
+    }
+    if (QFile::exists(fileName)) {
+        if (!parser.isSet(forceOption)) {
+            err << fileName << " already exists (use --force)" << endl;
+            return 2;
+        }
+        QFile::remove(fileName);
+    }
+
+    bool ok;
+    QString error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "datagen");
+        db.setDatabaseName(fileName);
+        ok = db.open();
+        if (!ok) {
+            error = db.lastError().text();
+        } else {
+            Generator generator(db, items, years, parser.value(seedOption).toULongLong());
+            ok = generator.run(&error);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("datagen");
+
+    if (!ok) {
+        err << "Generation failed: " << error << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+# Микробенчмарк ядра агрегации SUM(Quantity * UnitPrice) GROUP BY
+# против того же запроса в SQLite
+
+QT       += core sql
+QT       -= gui
+
+TARGET = kernelbench
+TEMPLATE = app
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        main.cpp \
+        ../../aggregatekernels.cpp
+
+HEADERS += \
+    ../../aggregatekernels.h
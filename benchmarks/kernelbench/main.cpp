@@ -0,0 +1,155 @@
+#include "aggregatekernels.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <cmath>
+
+// Использование: kernelbench [строк] [групп] [повторов]
+// Печатает строку для ядра и для SQLite: время лучшего прогона, строк/с и
+// ГБ/с по прочитанным столбцам (Quantity, UnitPrice, код группы)
+
+namespace
+{
+
+struct Data
+{
+    QVector<qint32> quantity;
+    QVector<double> unitPrice;
+    QVector<quint32> keys;
+};
+
+Data generate(int rows, int groups)
+{
+    Data data;
+    data.quantity.resize(rows);
+    data.unitPrice.resize(rows);
+    data.keys.resize(rows);
+    QRandomGenerator random(42);
+    for (int i = 0; i < rows; ++i) {
+        data.quantity[i] = 1 + int(random.bounded(5));
+        data.unitPrice[i] = random.bounded(2) ? 0.99 : 1.99;
+        data.keys[i] = random.bounded(quint32(groups));
+    }
+    return data;
+}
+
+void report(QTextStream &out, const QString &name, qint64 nsecs, int rows, double checksum)
+{
+    double seconds = nsecs / 1e9;
+    double bytes = double(rows) * (sizeof(qint32) + sizeof(double) + sizeof(quint32));
+    out << QString("%1 %2 ms %3 Mrows/s %4 GB/s checksum %5")
+               .arg(name, -8)
+               .arg(nsecs / 1e6, 10, 'f', 2)
+               .arg(rows / seconds / 1e6, 9, 'f', 1)
+               .arg(bytes / seconds / 1e9, 7, 'f', 2)
+               .arg(checksum, 0, 'f', 2)
+        << endl;
+}
+
+double benchmarkKernel(const Data &data, int groups, int repeats, qint64 *bestNsecs)
+{
+    QVector<qint64> rows(groups);
+    QVector<qint64> quantities(groups);
+    QVector<double> revenues(groups);
+    *bestNsecs = -1;
+    for (int run = 0; run < repeats; ++run) {
+        rows.fill(0);
+        quantities.fill(0);
+        revenues.fill(0.0);
+        QElapsedTimer timer;
+        timer.start();
+        AggregateKernels::sumProductByKey(data.quantity.constData(), data.unitPrice.constData(),
+                                          data.keys.constData(), data.keys.size(),
+                                          rows.data(), quantities.data(), revenues.data());
+        qint64 elapsed = timer.nsecsElapsed();
+        if (*bestNsecs < 0 || elapsed < *bestNsecs) {
+            *bestNsecs = elapsed;
+        }
+    }
+    double total = 0.0;
+    for (double revenue : revenues) {
+        total += revenue;
+    }
+    return total;
+}
+
+bool loadSqlite(QSqlDatabase &db, const Data &data)
+{
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE items (GroupId INTEGER, Quantity INTEGER, UnitPrice REAL)")) {
+        return false;
+    }
+    db.transaction();
+    query.prepare("INSERT INTO items VALUES (?, ?, ?)");
+    for (int i = 0; i < data.keys.size(); ++i) {
+        query.bindValue(0, data.keys[i]);
+        query.bindValue(1, data.quantity[i]);
+        query.bindValue(2, data.unitPrice[i]);
+        if (!query.exec()) {
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+double benchmarkSqlite(QSqlDatabase &db, int repeats, qint64 *bestNsecs)
+{
+    double total = 0.0;
+    *bestNsecs = -1;
+    for (int run = 0; run < repeats; ++run) {
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        QElapsedTimer timer;
+        timer.start();
+        query.exec("SELECT GroupId, SUM(Quantity * UnitPrice) FROM items GROUP BY GroupId");
+        double sum = 0.0;
+        while (query.next()) {
+            sum += query.value(1).toDouble();
+        }
+        qint64 elapsed = timer.nsecsElapsed();
+        if (*bestNsecs < 0 || elapsed < *bestNsecs) {
+            *bestNsecs = elapsed;
+        }
+        total = sum;
+    }
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    int rows = args.value(1, "5000000").toInt();
+    int groups = args.value(2, "25").toInt();
+    int repeats = args.value(3, "5").toInt();
+
+    QTextStream out(stdout);
+    out << "rows " << rows << ", groups " << groups << ", repeats " << repeats << endl;
+
+    Data data = generate(rows, groups);
+
+    qint64 kernelNsecs = 0;
+    double kernelChecksum = benchmarkKernel(data, groups, repeats, &kernelNsecs);
+    report(out, "kernel", kernelNsecs, rows, kernelChecksum);
+
+    // Тот же запрос в SQLite в памяти, без затрат на чтение с диска
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "bench");
+    db.setDatabaseName(":memory:");
+    if (!db.open() || !loadSqlite(db, data)) {
+        out << "sqlite: " << db.lastError().text() << endl;
+        return 1;
+    }
+    qint64 nsecs = 0;
+    double checksum = benchmarkSqlite(db, repeats, &nsecs);
+    report(out, "sqlite", nsecs, rows, checksum);
+    return 0;
+}
@@ -0,0 +1,323 @@
+// Замер отчётов от запроса до отрисовки таблицы:
+//   reportbench --db big.db [--runs 5] [--engine sql|columnar|partitioned]
+//               [--report имя]... [--out results.json] [ключи хранилища]
+// Результат — JSON с минимумом, медианой и максимумом по фазам для
+// отслеживания регрессий. Без дисплея работает на платформе offscreen
+#include "columnarengine.h"
+#include "partitionedaggregator.h"
+#include "reports.h"
+#include "resulttablemodel.h"
+#include "statementregistry.h"
+#include "storageconfig.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTableView>
+#include <QTextStream>
+#include <algorithm>
+
+namespace
+{
+
+// Фазы одного прогона, мс
+struct Sample
+{
+    double query = 0.0;       // выполнение до первой строки
+    double materialize = 0.0; // чтение всех строк в QueryResult
+    double render = 0.0;      // модель таблицы и отрисовка представления
+};
+
+double elapsedMs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1e6;
+}
+
+QJsonObject summary(QVector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    double total = 0.0;
+    for (double value : values) {
+        total += value;
+    }
+    int count = values.size();
+    double median = count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+    return QJsonObject{{"min", values.first()}, {"median", median}, {"mean", total / count},
+                       {"max", values.last()}};
+}
+
+DataVersion dataVersion(QSqlDatabase &db)
+{
+    DataVersion version;
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA data_version") && query.next()) {
+        version.dataVersion = query.value(0).toLongLong();
+    }
+    if (query.exec("SELECT MAX(InvoiceId) FROM invoices") && query.next()) {
+        version.maxInvoiceId = query.value(0).toLongLong();
+    }
+    return version;
+}
+
+class Bench
+{
+public:
+    enum class Engine { Sql, Columnar, Partitioned };
+
+    Bench(QSqlDatabase &db, const ConnectionPoolPtr &connections, Engine engine)
+        : db(db)
+        , engine(engine)
+        , partitioned(connections)
+        , loadMs(0.0)
+    {
+        view.setModel(&model);
+        view.verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        view.resize(1280, 720);
+    }
+
+    // Колоночный движок загружается один раз, время загрузки — отдельно
+    bool prepare(QString *error)
+    {
+        if (engine != Engine::Columnar) {
+            return true;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        if (!columnar.ensureLoaded(db, dataVersion(db))) {
+            *error = "columnar engine failed to load";
+            return false;
+        }
+        loadMs = elapsedMs(timer);
+        return true;
+    }
+
+    double engineLoadMs() const { return loadMs; }
+
+    bool run(const ReportDefinition &report, Sample *sample, QueryResult *result, QString *error)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        if (engine == Engine::Columnar && columnar.supports(report.id)) {
+            *result = columnar.run(report.id);
+            sample->query = elapsedMs(timer);
+        } else if (engine == Engine::Partitioned && partitioned.supports(report.id)) {
+            QAtomicInt cancel(0);
+            *result = partitioned.run(db, report.id, cancel);
+            sample->query = elapsedMs(timer);
+        } else if (!runSql(report, sample, result, error)) {
+            return false;
+        }
+        if (!result->error.isEmpty()) {
+            *error = result->error;
+            return false;
+        }
+
+        // Как displayTable: модель, подбор ширины столбцов, отрисовка
+        timer.restart();
+        model.setResult(*result, result->columns);
+        view.resizeColumnsToContents();
+        view.grab();
+        sample->render = elapsedMs(timer);
+        return true;
+    }
+
+private:
+    bool runSql(const ReportDefinition &report, Sample *sample, QueryResult *result, QString *error)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QSqlQuery query(db);
+        if (!statements.prepare(db, report.name, report.sql, error)) {
+            return false;
+        }
+        if (!statements.exec(report.name, QVariantMap(), Reports::defaultParams(), &query)) {
+            *error = query.lastError().text();
+            return false;
+        }
+        bool hasRow = query.next();
+        sample->query = elapsedMs(timer);
+
+        // Раскладка по столбцам — как в QueryWorker::execute
+        timer.restart();
+        *result = QueryResult();
+        QSqlRecord record = query.record();
+        int columnCount = record.count();
+        for (int col = 0; col < columnCount; ++col) {
+            result->columns << record.fieldName(col);
+        }
+        result->data.resize(columnCount);
+        for (; hasRow; hasRow = query.next()) {
+            for (int col = 0; col < columnCount; ++col) {
+                result->data[col].append(query.value(col));
+            }
+        }
+        query.finish();
+        sample->materialize = elapsedMs(timer);
+        return true;
+    }
+
+    QSqlDatabase &db;
+    Engine engine;
+    StatementRegistry statements;
+    ColumnarEngine columnar;
+    PartitionedAggregator partitioned;
+    double loadMs;
+    ResultTableModel model;
+    QTableView view;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Замер отчётов: запрос, чтение строк, отрисовка таблицы");
+    parser.addHelpOption();
+    QCommandLineOption runsOption("runs", "Число замеряемых прогонов.", "count", "5");
+    QCommandLineOption warmupOption("warmup", "Число прогонов для прогрева.", "count", "1");
+    QCommandLineOption engineOption("engine", "sql, columnar или partitioned.", "engine", "sql");
+    QCommandLineOption reportOption("report", "Замерять только этот отчёт; можно повторять.", "name");
+    QCommandLineOption outOption("out", "Файл JSON; по умолчанию стандартный вывод.", "file");
+    parser.addOptions({runsOption, warmupOption, engineOption, reportOption, outOption});
+    StorageConfig::addOptions(&parser);
+    parser.process(app);
+
+    int runs = qMax(1, parser.value(runsOption).toInt());
+    int warmup = qMax(0, parser.value(warmupOption).toInt());
+    QString engineName = parser.value(engineOption);
+    Bench::Engine engine;
+    if (engineName == "sql") {
+        engine = Bench::Engine::Sql;
+    } else if (engineName == "columnar") {
+        engine = Bench::Engine::Columnar;
+    } else if (engineName == "partitioned") {
+        engine = Bench::Engine::Partitioned;
+    } else {
+        err << "Unknown engine: " << engineName << endl;
+        return 2;
+    }
+
+    // Колоночный и параллельный движки работают по копии данных SQLite
+    StorageConfig storage = StorageConfig::fromParser(parser);
+    if (engine != Bench::Engine::Sql && storage.dialect != SqlDialect::Sqlite) {
+        err << "Engine " << engineName << " requires the sqlite backend" << endl;
+        return 2;
+    }
+
+    QList<ReportDefinition> reports;
+    QStringList selected = parser.values(reportOption);
+    for (const ReportDefinition &report : Reports::all(storage.dialect)) {
+        if (selected.isEmpty() || selected.contains(report.name)) {
+            reports << report;
+        }
+    }
+    if (reports.isEmpty()) {
+        err << "No reports selected" << endl;
+        return 2;
+    }
+
+    ConnectionPoolPtr connections(new ConnectionPool(storage));
+    QJsonObject output;
+    bool ok = true;
+    QString error;
+    {
+        QSqlDatabase db = connections->database(&error);
+        ok = db.isOpen();
+
+        QSqlQuery info(db);
+        qint64 items = info.exec("SELECT COUNT(*) FROM invoice_items") && info.next() ? info.value(0).toLongLong() : -1;
+        bool sqlite = storage.dialect == SqlDialect::Sqlite;
+        QString serverVersion = info.exec(sqlite ? "SELECT sqlite_version()" : "SELECT version()") && info.next()
+                                    ? info.value(0).toString() : QString();
+
+        Bench bench(db, connections, engine);
+        ok = ok && bench.prepare(&error);
+
+        QJsonArray results;
+        for (int i = 0; ok && i < reports.size(); ++i) {
+            const ReportDefinition &report = reports[i];
+            QVector<double> query, materialize, render, total;
+            QueryResult result;
+            for (int run = 0; ok && run < warmup + runs; ++run) {
+                Sample sample;
+                ok = bench.run(report, &sample, &result, &error);
+                if (ok && run >= warmup) {
+                    query << sample.query;
+                    materialize << sample.materialize;
+                    render << sample.render;
+                    total << sample.query + sample.materialize + sample.render;
+                }
+            }
+            if (!ok) {
+                error = report.name + ": " + error;
+                break;
+            }
+            err << report.name << ": " << summary(total).value("median").toDouble() << " ms" << endl;
+            results.append(QJsonObject{
+                {"name", report.name},
+                {"rows", result.rowCount()},
+                {"columns", result.columns.size()},
+                {"queryMs", summary(query)},
+                {"materializeMs", summary(materialize)},
+                {"renderMs", summary(render)},
+                {"totalMs", summary(total)}
+            });
+        }
+
+        output = QJsonObject{
+            {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+            {"database", storage.databasePath},
+            {"storage", QJsonObject{
+                {"mmapSize", storage.mmapSize},
+                {"cacheSizeKiB", storage.cacheSizeKiB},
+                {"tempStoreMemory", storage.tempStoreMemory},
+                {"wal", storage.wal},
+                {"readOnly", storage.readOnly},
+                {"immutable", storage.immutable}
+            }},
+            {"invoiceItems", items},
+            {"backend", Dialect::name(storage.dialect)},
+            {"sqliteVersion", sqlite ? serverVersion : QString()},
+            {"serverVersion", sqlite ? QString() : serverVersion},
+            {"qtVersion", QString(qVersion())},
+            {"engine", engineName},
+            {"engineLoadMs", bench.engineLoadMs()},
+            {"runs", runs},
+            {"warmup", warmup},
+            {"reports", results}
+        };
+    }
+    connections->release();
+
+    if (!ok) {
+        err << "Benchmark failed: " << error << endl;
+        return 1;
+    }
+
+    QByteArray json = QJsonDocument(output).toJson();
+    QString fileName = parser.value(outOption);
+    if (fileName.isEmpty()) {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+        err << "Cannot write " << fileName << ": " << file.errorString() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#-------------------------------------------------
+#
+# Замер отчётов на больших базах (см. ../datagen)
+#
+#-------------------------------------------------
+
+QT       += core gui sql widgets
+
+TARGET = reportbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+DEFINES += SALESANALYTICS_SOURCE_DIR=\\\"$$clean_path($$PWD/../..)\\\"
+
+SOURCES += \
+        main.cpp \
+        ../../reports.cpp \
+        ../../reportcache.cpp \
+        ../../queryresult.cpp \
+        ../../resulttablemodel.cpp \
+        ../../columnarengine.cpp \
+        ../../dictionarycodes.cpp \
+        ../../aggregatekernels.cpp \
+        ../../partitionedaggregator.cpp \
+        ../../statementregistry.cpp \
+        ../../storageconfig.cpp \
+        ../../sqldialect.cpp
+
+HEADERS += \
+    ../../reports.h \
+    ../../reportcache.h \
+    ../../queryresult.h \
+    ../../resulttablemodel.h \
+    ../../columnarengine.h \
+    ../../dictionarycodes.h \
+    ../../aggregatekernels.h \
+    ../../partitionedaggregator.h \
+    ../../statementregistry.h \
+    ../../storageconfig.h \
+    ../../sqldialect.h
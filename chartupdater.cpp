@@ -0,0 +1,264 @@
+#include "chartupdater.h"
+#include "tracing.h"
+#include <algorithm>
+
+ChartUpdater::ChartUpdater(QChartView *view, QObject *parent)
+    : QObject(parent)
+    , view(view)
+    , current(nullptr)
+    , kind(Kind::Custom)
+    , glMode(OpenGLMode::Auto)
+    , downsampling(Downsampling::Method::Lttb)
+    , bars(nullptr)
+    , barAxisX(nullptr)
+    , barAxisY(nullptr)
+    , line(nullptr)
+    , lineAxisX(nullptr)
+    , lineAxisY(nullptr)
+    , windowMinX(0)
+    , windowMaxX(0)
+    , updatingRange(false)
+{
+    view->setRenderHint(QPainter::Antialiasing);
+}
+
+void ChartUpdater::setOpenGLMode(OpenGLMode mode)
+{
+    glMode = mode;
+    if (lineSeries()) {
+        applyOpenGL(linePoints.size());
+    }
+}
+
+void ChartUpdater::setDownsamplingMethod(Downsampling::Method method)
+{
+    downsampling = method;
+    if (lineSeries()) {
+        refreshLine(windowMinX, windowMaxX);
+    }
+}
+
+void ChartUpdater::install(QChart *chart, Kind newKind)
+{
+    // QChartView не удаляет прежнюю диаграмму сам. Удаление отложено:
+    // диаграмму могут заменить из обработчика щелчка по её же сегменту,
+    // пока событие мыши ещё обрабатывается её элементами
+    QChart *previous = view->chart();
+    view->setChart(chart);
+    if (previous && previous != chart) {
+        for (QAbstractAxis *axis : previous->axes()) {
+            disconnect(axis, nullptr, this, nullptr);
+        }
+        previous->deleteLater();
+    }
+    current = chart;
+    kind = newKind;
+    bars = nullptr;
+    barAxisX = nullptr;
+    barAxisY = nullptr;
+    line = nullptr;
+    lineAxisX = nullptr;
+    lineAxisY = nullptr;
+    linePoints.clear();
+
+    // Рамкой выделяется окно по X, правая кнопка возвращает масштаб
+    view->setRubberBand(newKind == Kind::Line ? QChartView::HorizontalRubberBand : QChartView::NoRubberBand);
+}
+
+void ChartUpdater::setChart(QChart *chart)
+{
+    install(chart, Kind::Custom);
+}
+
+void ChartUpdater::clear()
+{
+    install(new QChart(), Kind::Custom);
+}
+
+bool ChartUpdater::reuse(Kind wanted)
+{
+    return current && view->chart() == current && kind == wanted;
+}
+
+void ChartUpdater::setAnimated(int points)
+{
+    QChart::AnimationOptions options = points > AnimationPointLimit ? QChart::NoAnimation : QChart::SeriesAnimations;
+    if (current->animationOptions() != options) {
+        current->setAnimationOptions(options);
+    }
+}
+
+void ChartUpdater::applyOpenGL(int points)
+{
+    bool useOpenGL = glMode == OpenGLMode::Always || (glMode == OpenGLMode::Auto && points >= OpenGLPointLimit);
+    if (line->useOpenGL() != useOpenGL) {
+        line->setUseOpenGL(useOpenGL);
+    }
+}
+
+void ChartUpdater::showBars(const QString &title, const QStringList &categories, const QVector<BarSetData> &sets,
+                            bool stacked, const QString &xTitle, const QString &yTitle, int labelsAngle)
+{
+    TRACE_SCOPE("ChartUpdater::showBars");
+    Tracing::counter("bars", categories.size() * sets.size());
+    Kind wanted = stacked ? Kind::StackedBars : Kind::Bars;
+    if (!reuse(wanted)) {
+        QChart *chart = new QChart();
+        install(chart, wanted);
+        bars = stacked ? static_cast<QAbstractBarSeries *>(new QStackedBarSeries())
+                       : static_cast<QAbstractBarSeries *>(new QBarSeries());
+        chart->addSeries(bars);
+
+        barAxisX = new QBarCategoryAxis();
+        chart->addAxis(barAxisX, Qt::AlignBottom);
+        bars->attachAxis(barAxisX);
+
+        barAxisY = new QValueAxis();
+        chart->addAxis(barAxisY, Qt::AlignLeft);
+        bars->attachAxis(barAxisY);
+
+        chart->legend()->setVisible(true);
+        chart->legend()->setAlignment(Qt::AlignBottom);
+    }
+
+    current->setTitle(title);
+    barAxisX->setTitleText(xTitle);
+    barAxisX->setLabelsAngle(labelsAngle);
+    barAxisY->setTitleText(yTitle);
+    setAnimated(categories.size() * sets.size());
+
+    // Наборы переиспользуются по порядку; значения заменяются целиком
+    QList<QBarSet *> existing = bars->barSets();
+    while (existing.size() > sets.size()) {
+        bars->remove(existing.takeLast());
+    }
+    QList<QBarSet *> added;
+    for (int i = 0; i < sets.size(); ++i) {
+        QBarSet *set;
+        if (i < existing.size()) {
+            set = existing[i];
+            set->setLabel(sets[i].name);
+            set->remove(0, set->count());
+        } else {
+            set = new QBarSet(sets[i].name);
+            added.append(set);
+        }
+        set->append(sets[i].values);
+    }
+    if (!added.isEmpty()) {
+        bars->append(added);
+    }
+    barAxisX->setCategories(categories);
+
+    // Шкала по наибольшему столбцу (для накопления — по сумме наборов)
+    qreal maxValue = 0;
+    for (int category = 0; category < categories.size(); ++category) {
+        qreal column = 0;
+        for (const BarSetData &set : sets) {
+            qreal value = category < set.values.size() ? set.values[category] : 0;
+            column = stacked ? column + value : qMax(column, value);
+        }
+        maxValue = qMax(maxValue, column);
+    }
+    barAxisY->setRange(0, maxValue > 0 ? maxValue : 1);
+    barAxisY->applyNiceNumbers();
+}
+
+void ChartUpdater::showLine(const QString &title, const QVector<QPointF> &points, bool dateAxis,
+                            const QString &xFormat, const QString &xTitle, const QString &yTitle)
+{
+    bool axisMatches = lineAxisX && (qobject_cast<QDateTimeAxis *>(lineAxisX) != nullptr) == dateAxis;
+    if (!reuse(Kind::Line) || !axisMatches) {
+        QChart *chart = new QChart();
+        install(chart, Kind::Line);
+        line = new QLineSeries();
+        chart->addSeries(line);
+
+        if (dateAxis) {
+            QDateTimeAxis *dates = new QDateTimeAxis();
+            connect(dates, &QDateTimeAxis::rangeChanged, this, [this](const QDateTime &min, const QDateTime &max) {
+                onLineRangeChanged(min.toMSecsSinceEpoch(), max.toMSecsSinceEpoch());
+            });
+            lineAxisX = dates;
+        } else {
+            QValueAxis *values = new QValueAxis();
+            connect(values, &QValueAxis::rangeChanged, this, &ChartUpdater::onLineRangeChanged);
+            lineAxisX = values;
+        }
+        chart->addAxis(lineAxisX, Qt::AlignBottom);
+        line->attachAxis(lineAxisX);
+
+        lineAxisY = new QValueAxis();
+        chart->addAxis(lineAxisY, Qt::AlignLeft);
+        line->attachAxis(lineAxisY);
+
+        chart->legend()->hide();
+    }
+
+    current->setTitle(title);
+    lineAxisX->setTitleText(xTitle);
+    if (QDateTimeAxis *dates = qobject_cast<QDateTimeAxis *>(lineAxisX)) {
+        dates->setFormat(xFormat);
+    } else if (QValueAxis *values = qobject_cast<QValueAxis *>(lineAxisX)) {
+        values->setLabelFormat(xFormat.isEmpty() ? QString("%g") : xFormat);
+    }
+    lineAxisY->setTitleText(yTitle);
+    linePoints = points;
+    applyOpenGL(points.size());
+    if (points.isEmpty()) {
+        line->clear();
+        return;
+    }
+
+    // Шкала Y по всему ряду, чтобы она не прыгала при смене окна
+    qreal minY = points.first().y();
+    qreal maxY = points.first().y();
+    for (const QPointF &point : points) {
+        minY = qMin(minY, point.y());
+        maxY = qMax(maxY, point.y());
+    }
+    lineAxisY->setRange(qMin<qreal>(0, minY), maxY > 0 ? maxY : 1);
+    lineAxisY->applyNiceNumbers();
+
+    refreshLine(points.first().x(), points.last().x());
+}
+
+int ChartUpdater::linePointBudget() const
+{
+    // Пара точек на пиксель ширины хватает и для огибающей min/max
+    return qBound(200, 2 * view->width(), MaxLinePoints);
+}
+
+void ChartUpdater::onLineRangeChanged(qreal minX, qreal maxX)
+{
+    if (!updatingRange && lineSeries()) {
+        refreshLine(minX, maxX);
+    }
+}
+
+void ChartUpdater::refreshLine(qreal minX, qreal maxX)
+{
+    TRACE_SCOPE("ChartUpdater::refreshLine");
+    windowMinX = minX;
+    windowMaxX = maxX;
+    QVector<QPointF> sampled = Downsampling::downsample(downsampling, Downsampling::window(linePoints, minX, maxX),
+                                                        linePointBudget());
+    Tracing::counter("line points", sampled.size());
+    setAnimated(sampled.size());
+
+    // Одна замена вместо сигнала на каждую точку; окно восстанавливается,
+    // если серия расширила диапазон по соседним точкам
+    updatingRange = true;
+    line->replace(sampled);
+    setLineRange(minX, maxX);
+    updatingRange = false;
+}
+
+void ChartUpdater::setLineRange(qreal minX, qreal maxX)
+{
+    if (QDateTimeAxis *dates = qobject_cast<QDateTimeAxis *>(lineAxisX)) {
+        dates->setRange(QDateTime::fromMSecsSinceEpoch(qint64(minX)), QDateTime::fromMSecsSinceEpoch(qint64(maxX)));
+    } else {
+        lineAxisX->setRange(minX, maxX);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef CHARTUPDATER_H
+#define CHARTUPDATER_H
+
+#include "downsampling.h"
+#include <QObject>
+#include <QPointF>
+#include <QStringList>
+#include <QVector>
+#include <QtCharts>
+
+QT_CHARTS_USE_NAMESPACE
+
+// Обновление диаграмм в QChartView без пересоздания: пока вид диаграммы
+// (столбцы, столбцы с накоплением, линия) не меняется, QChart, серии и
+// оси переиспользуются, а данные заменяются одним вызовом на серию.
+// Анимация отключается для больших наборов точек, длинные линии
+// рисуются через OpenGL. Линия хранит исходные точки, а в серию попадает
+// прореженный ряд видимого окна: при каждом изменении диапазона оси X
+// (выделение рамкой, сброс масштаба) он пересчитывается заново.
+// Все диаграммы вида проходят через этот класс, чтобы заменённый QChart
+// удалялся
+class ChartUpdater : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Анимация серий только до этого числа точек
+    static const int AnimationPointLimit = 500;
+    // Линия рисуется через OpenGL начиная с этого числа точек (режим Auto)
+    static const int OpenGLPointLimit = 5000;
+    // Больше точек линии не рисуется, сколько бы их ни было в ряду
+    static const int MaxLinePoints = 4000;
+
+    enum class OpenGLMode { Auto, Always, Never };
+
+    struct BarSetData
+    {
+        QString name;
+        QList<qreal> values; // по значению на категорию
+    };
+
+    explicit ChartUpdater(QChartView *view, QObject *parent = nullptr);
+
+    void setOpenGLMode(OpenGLMode mode);
+    OpenGLMode openGLMode() const { return glMode; }
+    void setDownsamplingMethod(Downsampling::Method method);
+
+    // Готовая диаграмма (например, круговая); предыдущая удаляется
+    void setChart(QChart *chart);
+    void clear();
+
+    void showBars(const QString &title, const QStringList &categories, const QVector<BarSetData> &sets,
+                  bool stacked, const QString &xTitle, const QString &yTitle, int labelsAngle = 0);
+
+    // Линия по оси дат (x — мс от эпохи) или по числовой оси
+    void showLine(const QString &title, const QVector<QPointF> &points, bool dateAxis, const QString &xFormat,
+                  const QString &xTitle, const QString &yTitle);
+
+    QChart *chart() const { return current; }
+    QLineSeries *lineSeries() const { return kind == Kind::Line ? line : nullptr; }
+
+private:
+    enum class Kind { Custom, Bars, StackedBars, Line };
+
+    // QChart нужного вида: текущий, если он ещё показан в виде, иначе новый
+    bool reuse(Kind wanted);
+    void install(QChart *chart, Kind newKind);
+    void setAnimated(int points);
+    void applyOpenGL(int points);
+    int linePointBudget() const;
+    void onLineRangeChanged(qreal minX, qreal maxX);
+    void refreshLine(qreal minX, qreal maxX);
+    void setLineRange(qreal minX, qreal maxX);
+
+    QChartView *view;
+    QChart *current;
+    Kind kind;
+    OpenGLMode glMode;
+    Downsampling::Method downsampling;
+
+    QAbstractBarSeries *bars;
+    QBarCategoryAxis *barAxisX;
+    QValueAxis *barAxisY;
+    QLineSeries *line;
+    QAbstractAxis *lineAxisX;
+    QValueAxis *lineAxisY;
+    QVector<QPointF> linePoints; // исходный ряд, упорядочен по x
+    qreal windowMinX;
+    qreal windowMaxX;
+    bool updatingRange;
+};
+
+#endif // CHARTUPDATER_H
@@ -0,0 +1,427 @@
+#include "columnarengine.h"
+#include "dictionarycodes.h"
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+#include <algorithm>
+
+namespace
+{
+
+struct Totals
+{
+    qint64 rows = 0;
+    qint64 quantity = 0;
+    double revenue = 0.0;
+};
+
+// Агрегация по коду группы: плотные массивы, пока пространство ключей
+// невелико, иначе хеш-таблица
+class GroupTotals
+{
+public:
+    static const quint64 DenseKeyLimit = 1u << 22;
+
+    explicit GroupTotals(quint64 keySpace)
+        : dense(keySpace <= DenseKeyLimit)
+    {
+        if (dense) {
+            rows.resize(int(keySpace));
+            quantities.resize(int(keySpace));
+            revenues.resize(int(keySpace));
+        }
+    }
+
+    bool isDense() const { return dense; }
+
+    // Все строки за один проход ядра агрегации; только для плотных групп
+    void addAll(const QVector<quint32> &keys, const QVector<qint32> &quantity, const double *unitPrice)
+    {
+        AggregateKernels::sumProductByKey(quantity.constData(), unitPrice, keys.constData(), keys.size(),
+                                          rows.data(), quantities.data(), unitPrice ? revenues.data() : nullptr);
+    }
+
+    void add(quint64 key, qint32 quantity, double amount)
+    {
+        Totals &group = sparse[key];
+        ++group.rows;
+        group.quantity += quantity;
+        group.revenue += amount;
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const
+    {
+        if (dense) {
+            for (int key = 0; key < rows.size(); ++key) {
+                if (rows[key] > 0) {
+                    Totals totals;
+                    totals.rows = rows[key];
+                    totals.quantity = quantities[key];
+                    totals.revenue = revenues[key];
+                    visit(quint64(key), totals);
+                }
+            }
+        } else {
+            for (auto it = sparse.constBegin(); it != sparse.constEnd(); ++it) {
+                visit(it.key(), it.value());
+            }
+        }
+    }
+
+private:
+    bool dense;
+    QVector<qint64> rows;
+    QVector<qint64> quantities;
+    QVector<double> revenues;
+    QHash<quint64, Totals> sparse;
+};
+
+// Группировка по одному измерению (outer) или по паре (outer, inner).
+// Строки, где хотя бы один код отсутствует, пропускаются, как при JOIN
+GroupTotals aggregate(const QVector<qint32> &quantity, const QVector<double> &unitPrice, bool withRevenue,
+                      const QVector<quint32> &outer, quint64 outerSize,
+                      const QVector<quint32> *inner = nullptr, quint64 innerSize = 1)
+{
+    GroupTotals groups(outerSize * innerSize);
+    const double *prices = withRevenue ? unitPrice.constData() : nullptr;
+    if (groups.isDense()) {
+        if (!inner) {
+            groups.addAll(outer, quantity, prices);
+            return groups;
+        }
+        QVector<quint32> keys(outer.size());
+        for (int i = 0; i < keys.size(); ++i) {
+            bool missing = outer[i] == ColumnarEngine::NoKey || inner->at(i) == ColumnarEngine::NoKey;
+            keys[i] = missing ? AggregateKernels::SkipKey : quint32(outer[i] * innerSize + inner->at(i));
+        }
+        groups.addAll(keys, quantity, prices);
+        return groups;
+    }
+
+    for (int i = 0; i < outer.size(); ++i) {
+        if (outer[i] == ColumnarEngine::NoKey || (inner && inner->at(i) == ColumnarEngine::NoKey)) {
+            continue;
+        }
+        quint64 key = quint64(outer[i]) * innerSize + (inner ? inner->at(i) : 0);
+        groups.add(key, quantity[i], prices ? quantity[i] * prices[i] : 0.0);
+    }
+    return groups;
+}
+
+struct InvoiceKeys
+{
+    quint32 month;
+    quint32 country;
+};
+
+struct TrackKeys
+{
+    quint32 genre;
+    quint32 artist;
+};
+
+} // namespace
+
+const quint32 ColumnarEngine::NoKey;
+
+ColumnarEngine::ColumnarEngine()
+    : loaded(false)
+{
+}
+
+bool ColumnarEngine::supports(ReportId report) const
+{
+    switch (report) {
+    case ReportId::MonthlySales:
+    case ReportId::RevenueByGenre:
+    case ReportId::ArtistsByGenre:
+    case ReportId::TopArtists:
+    case ReportId::SalesByCountryGenre:
+        return true;
+    case ReportId::SalesByCity:
+        break;
+    }
+    return false;
+}
+
+bool ColumnarEngine::ensureLoaded(QSqlDatabase &db, const DataVersion &version)
+{
+    if (loaded && version.isValid() && version == loadedVersion) {
+        return true;
+    }
+    loaded = load(db);
+    loadedVersion = loaded ? version : DataVersion();
+    return loaded;
+}
+
+bool ColumnarEngine::load(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // Измерения: id строки таблицы -> код в словаре
+    QHash<qint64, quint32> genreCodes;
+    QStringList genres;
+    if (!query.exec("SELECT GenreId, Name FROM genres")) {
+        qDebug() << "Columnar load error:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        genreCodes.insert(query.value(0).toLongLong(), quint32(genres.size()));
+        genres.append(query.value(1).toString());
+    }
+
+    QHash<qint64, quint32> artistCodes;
+    QStringList artists;
+    if (!query.exec("SELECT ArtistId, Name FROM artists")) {
+        qDebug() << "Columnar load error:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        artistCodes.insert(query.value(0).toLongLong(), quint32(artists.size()));
+        artists.append(query.value(1).toString());
+    }
+
+    QHash<qint64, quint32> albumArtists;
+    if (!query.exec("SELECT AlbumId, ArtistId FROM albums")) {
+        qDebug() << "Columnar load error:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        albumArtists.insert(query.value(0).toLongLong(), artistCodes.value(query.value(1).toLongLong(), NoKey));
+    }
+
+    QHash<qint64, TrackKeys> tracks;
+    if (!query.exec("SELECT TrackId, AlbumId, GenreId FROM tracks")) {
+        qDebug() << "Columnar load error:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        TrackKeys keys;
+        keys.artist = query.value(1).isNull() ? NoKey : albumArtists.value(query.value(1).toLongLong(), NoKey);
+        keys.genre = query.value(2).isNull() ? NoKey : genreCodes.value(query.value(2).toLongLong(), NoKey);
+        tracks.insert(query.value(0).toLongLong(), keys);
+    }
+
+    QHash<qint64, InvoiceKeys> invoices;
+    QHash<QString, quint32> monthCodes;
+    QHash<QString, quint32> countryCodes;
+    QStringList months;
+    QStringList countries;
+    if (!query.exec("SELECT InvoiceId, strftime('%Y-%m', InvoiceDate), BillingCountry FROM invoices")) {
+        qDebug() << "Columnar load error:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        InvoiceKeys keys;
+        keys.month = DictionaryCodes::internName(monthCodes, months, query.value(1).toString());
+        keys.country = DictionaryCodes::internName(countryCodes, countries, query.value(2).toString());
+        invoices.insert(query.value(0).toLongLong(), keys);
+    }
+
+    // Факты: соединения разрешаются здесь один раз для каждой строки счёта
+    int expectedItems = 0;
+    if (query.exec("SELECT COUNT(*) FROM invoice_items") && query.next()) {
+        expectedItems = query.value(0).toInt();
+    }
+    QVector<qint32> quantity;
+    QVector<double> unitPrice;
+    QVector<quint32> month;
+    QVector<quint32> country;
+    QVector<quint32> genre;
+    QVector<quint32> artist;
+    quantity.reserve(expectedItems);
+    unitPrice.reserve(expectedItems);
+    month.reserve(expectedItems);
+    country.reserve(expectedItems);
+    genre.reserve(expectedItems);
+    artist.reserve(expectedItems);
+
+    if (!query.exec("SELECT InvoiceId, TrackId, Quantity, UnitPrice FROM invoice_items")) {
+        qDebug() << "Columnar load error:" << query.lastError().text();
+        return false;
+    }
+    const InvoiceKeys missingInvoice = {NoKey, NoKey};
+    const TrackKeys missingTrack = {NoKey, NoKey};
+    while (query.next()) {
+        InvoiceKeys invoice = invoices.value(query.value(0).toLongLong(), missingInvoice);
+        TrackKeys track = tracks.value(query.value(1).toLongLong(), missingTrack);
+        quantity.append(query.value(2).toInt());
+        unitPrice.append(query.value(3).toDouble());
+        month.append(invoice.month);
+        country.append(invoice.country);
+        genre.append(track.genre);
+        artist.append(track.artist);
+    }
+
+    monthNames = months;
+    countryNames = countries;
+    genreNames = genres;
+    artistNames = artists;
+    itemQuantity = quantity;
+    itemUnitPrice = unitPrice;
+    itemMonth = month;
+    itemCountry = country;
+    itemGenre = genre;
+    itemArtist = artist;
+    return true;
+}
+
+QueryResult ColumnarEngine::run(ReportId report) const
+{
+    switch (report) {
+    case ReportId::MonthlySales:
+        return monthlySales();
+    case ReportId::RevenueByGenre:
+        return revenueByGenre();
+    case ReportId::ArtistsByGenre:
+        return artistsByGenre();
+    case ReportId::TopArtists:
+        return topArtists(5);
+    case ReportId::SalesByCountryGenre:
+        return salesByCountryGenre();
+    case ReportId::SalesByCity:
+        break;
+    }
+    QueryResult result;
+    result.error = "Report is not supported by the columnar engine";
+    return result;
+}
+
+QueryResult ColumnarEngine::monthlySales() const
+{
+    GroupTotals groups = aggregate(itemQuantity, itemUnitPrice, false, itemMonth, quint64(monthNames.size()));
+
+    QVector<QPair<QString, qint64>> rows;
+    groups.forEach([&](quint64 key, const Totals &totals) {
+        rows.append(qMakePair(monthNames.at(int(key)), totals.quantity));
+    });
+    std::sort(rows.begin(), rows.end());
+
+    QueryResult result;
+    result.columns << "Month" << "TotalSales";
+    for (const auto &row : rows) {
+        result.appendRow({row.first, row.second});
+    }
+    return result;
+}
+
+QueryResult ColumnarEngine::revenueByGenre() const
+{
+    GroupTotals groups = aggregate(itemQuantity, itemUnitPrice, true, itemGenre, quint64(genreNames.size()));
+
+    QVector<QPair<QString, double>> rows;
+    groups.forEach([&](quint64 key, const Totals &totals) {
+        rows.append(qMakePair(genreNames.at(int(key)), Reports::roundToCents(totals.revenue)));
+    });
+    std::stable_sort(rows.begin(), rows.end(), [](const QPair<QString, double> &a, const QPair<QString, double> &b) {
+        return a.second > b.second;
+    });
+
+    QueryResult result;
+    result.columns << "GenreName" << "Revenue";
+    for (const auto &row : rows) {
+        result.appendRow({row.first, row.second});
+    }
+    return result;
+}
+
+QueryResult ColumnarEngine::artistsByGenre() const
+{
+    const quint64 artistCount = quint64(artistNames.size());
+    GroupTotals groups = aggregate(itemQuantity, itemUnitPrice, false, itemGenre, quint64(genreNames.size()),
+                                   &itemArtist, artistCount);
+
+    struct Row
+    {
+        quint32 genre;
+        quint32 artist;
+        qint64 sales;
+    };
+    QVector<Row> rows;
+    groups.forEach([&](quint64 key, const Totals &totals) {
+        rows.append({quint32(key / artistCount), quint32(key % artistCount), totals.quantity});
+    });
+    std::sort(rows.begin(), rows.end(), [this](const Row &a, const Row &b) {
+        int order = genreNames.at(int(a.genre)).compare(genreNames.at(int(b.genre)));
+        if (order != 0) {
+            return order < 0;
+        }
+        return a.sales > b.sales;
+    });
+
+    QueryResult result;
+    result.columns << "GenreName" << "ArtistName" << "TotalSales";
+    for (const Row &row : rows) {
+        result.appendRow({genreNames.at(int(row.genre)), artistNames.at(int(row.artist)), row.sales});
+    }
+    return result;
+}
+
+QueryResult ColumnarEngine::topArtists(int limit) const
+{
+    GroupTotals groups = aggregate(itemQuantity, itemUnitPrice, true, itemArtist, quint64(artistNames.size()));
+
+    struct Row
+    {
+        quint32 artist;
+        qint64 quantity;
+        double revenue;
+    };
+    QVector<Row> rows;
+    groups.forEach([&](quint64 key, const Totals &totals) {
+        rows.append({quint32(key), totals.quantity, Reports::roundToCents(totals.revenue)});
+    });
+
+    // Top-N без полной сортировки всех артистов
+    int count = qMin(limit, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [](const Row &a, const Row &b) {
+        return a.revenue > b.revenue;
+    });
+
+    QueryResult result;
+    result.columns << "ArtistName" << "TotalQuantity" << "TotalSales";
+    for (int i = 0; i < count; ++i) {
+        result.appendRow({artistNames.at(int(rows[i].artist)), rows[i].quantity, rows[i].revenue});
+    }
+    return result;
+}
+
+QueryResult ColumnarEngine::salesByCountryGenre() const
+{
+    const quint64 genreCount = quint64(genreNames.size());
+    GroupTotals groups = aggregate(itemQuantity, itemUnitPrice, true, itemCountry, quint64(countryNames.size()),
+                                   &itemGenre, genreCount);
+
+    struct Row
+    {
+        quint32 country;
+        quint32 genre;
+        qint64 quantity;
+        double revenue;
+    };
+    QVector<Row> rows;
+    groups.forEach([&](quint64 key, const Totals &totals) {
+        rows.append({quint32(key / genreCount), quint32(key % genreCount), totals.quantity,
+                     Reports::roundToCents(totals.revenue)});
+    });
+    std::sort(rows.begin(), rows.end(), [this](const Row &a, const Row &b) {
+        int order = countryNames.at(int(a.country)).compare(countryNames.at(int(b.country)));
+        if (order != 0) {
+            return order < 0;
+        }
+        if (a.quantity != b.quantity) {
+            return a.quantity > b.quantity;
+        }
+        return genreNames.at(int(a.genre)) < genreNames.at(int(b.genre));
+    });
+
+    QueryResult result;
+    result.columns << "BillingCountry" << "GenreName" << "TotalQuantity" << "TotalSales";
+    for (const Row &row : rows) {
+        result.appendRow({countryNames.at(int(row.country)), genreNames.at(int(row.genre)), row.quantity, row.revenue});
+    }
+    return result;
+}
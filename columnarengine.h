@@ -0,0 +1,61 @@
+#ifndef COLUMNARENGINE_H
+#define COLUMNARENGINE_H
+
+#include "aggregatekernels.h"
+#include "queryresult.h"
+#include "reportcache.h"
+#include "reports.h"
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVector>
+
+// Колоночный движок отчётов в памяти процесса. invoice_items, invoices,
+// tracks и albums загружаются один раз; соединения разрешаются при загрузке,
+// и каждая строка счёта хранится как набор целочисленных кодов измерений
+// (месяц, страна, жанр, артист) плюс количество и цена. Отчёты считаются
+// одним проходом по непрерывным массивам с агрегацией по кодам.
+// SQL-путь остаётся эталоном: результаты совпадают по столбцам и порядку
+class ColumnarEngine
+{
+public:
+    static const quint32 NoKey = AggregateKernels::SkipKey;
+
+    ColumnarEngine();
+
+    bool supports(ReportId report) const;
+
+    // Загружает данные, если они ещё не загружены или версия БД изменилась
+    bool ensureLoaded(QSqlDatabase &db, const DataVersion &version);
+    bool isLoaded() const { return loaded; }
+    int itemCount() const { return itemQuantity.size(); }
+
+    QueryResult run(ReportId report) const;
+
+private:
+    bool load(QSqlDatabase &db);
+
+    QueryResult monthlySales() const;
+    QueryResult revenueByGenre() const;
+    QueryResult artistsByGenre() const;
+    QueryResult topArtists(int limit) const;
+    QueryResult salesByCountryGenre() const;
+
+    bool loaded;
+    DataVersion loadedVersion;
+
+    // Словари измерений: код -> имя
+    QStringList monthNames;
+    QStringList countryNames;
+    QStringList genreNames;
+    QStringList artistNames;
+
+    // Столбцы строк счетов, по одному элементу на строку invoice_items
+    QVector<qint32> itemQuantity;
+    QVector<double> itemUnitPrice;
+    QVector<quint32> itemMonth;
+    QVector<quint32> itemCountry;
+    QVector<quint32> itemGenre;
+    QVector<quint32> itemArtist;
+};
+
+#endif // COLUMNARENGINE_H
@@ -0,0 +1,29 @@
+#include "dictionarycodes.h"
+
+quint32 DictionaryCodes::internName(QHash<QString, quint32> &codes, QStringList &names, const QString &name)
+{
+    auto it = codes.constFind(name);
+    if (it != codes.constEnd()) {
+        return it.value();
+    }
+    quint32 code = quint32(names.size());
+    codes.insert(name, code);
+    names.append(name);
+    return code;
+}
+
+quint32 DictionaryCodes::internId(QHash<qint64, quint32> &codes, QStringList &names, const QVariant &id,
+                                  const QVariant &name)
+{
+    if (id.isNull()) {
+        return NoKey;
+    }
+    auto it = codes.constFind(id.toLongLong());
+    if (it != codes.constEnd()) {
+        return it.value();
+    }
+    quint32 code = quint32(names.size());
+    codes.insert(id.toLongLong(), code);
+    names.append(name.toString());
+    return code;
+}
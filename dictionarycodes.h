@@ -0,0 +1,23 @@
+#ifndef DICTIONARYCODES_H
+#define DICTIONARYCODES_H
+
+#include <QHash>
+#include <QStringList>
+#include <QVariant>
+
+// Словарное кодирование измерений кубов и колоночного движка: значение
+// получает номер своей строки в списке имён, коды плотные, с нуля
+namespace DictionaryCodes
+{
+
+// Код отсутствующего значения (нет строки справочника при LEFT JOIN)
+const quint32 NoKey = 0xFFFFFFFFu;
+
+// Код по самому значению; новое значение дописывается в names
+quint32 internName(QHash<QString, quint32> &codes, QStringList &names, const QString &name);
+// Код по id строки справочника, имя берётся при первой встрече; NULL -> NoKey
+quint32 internId(QHash<qint64, quint32> &codes, QStringList &names, const QVariant &id, const QVariant &name);
+
+} // namespace DictionaryCodes
+
+#endif // DICTIONARYCODES_H
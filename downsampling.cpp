@@ -0,0 +1,127 @@
+#include "downsampling.h"
+#include <algorithm>
+#include <cmath>
+
+QVector<QPointF> Downsampling::lttb(const QVector<QPointF> &points, int threshold)
+{
+    int count = points.size();
+    if (threshold >= count || threshold < 2) {
+        return points;
+    }
+    if (threshold == 2) {
+        return QVector<QPointF>() << points.first() << points.last();
+    }
+
+    QVector<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.first());
+
+    // Внутренние точки делятся на threshold - 2 корзины
+    double every = double(count - 2) / (threshold - 2);
+    int previous = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Среднее следующей корзины (для последней — последняя точка)
+        int nextStart = int(std::floor((bucket + 1) * every)) + 1;
+        int nextEnd = qMin(int(std::floor((bucket + 2) * every)) + 1, count);
+        double averageX = 0;
+        double averageY = 0;
+        for (int i = nextStart; i < nextEnd; ++i) {
+            averageX += points[i].x();
+            averageY += points[i].y();
+        }
+        int nextCount = nextEnd - nextStart;
+        if (nextCount > 0) {
+            averageX /= nextCount;
+            averageY /= nextCount;
+        } else {
+            averageX = points.last().x();
+            averageY = points.last().y();
+        }
+
+        // Точка текущей корзины с наибольшей площадью треугольника
+        int start = int(std::floor(bucket * every)) + 1;
+        int end = qMin(int(std::floor((bucket + 1) * every)) + 1, count - 1);
+        const QPointF &a = points[previous];
+        double maxArea = -1;
+        int chosen = start;
+        for (int i = start; i < end; ++i) {
+            double area = std::fabs((a.x() - averageX) * (points[i].y() - a.y())
+                                    - (a.x() - points[i].x()) * (averageY - a.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                chosen = i;
+            }
+        }
+        sampled.append(points[chosen]);
+        previous = chosen;
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
+QVector<QPointF> Downsampling::minMax(const QVector<QPointF> &points, int threshold)
+{
+    int count = points.size();
+    if (threshold >= count || threshold < 2) {
+        return points;
+    }
+
+    // Первая и последняя точки отдельно, на корзину — две точки
+    int buckets = (threshold - 2) / 2;
+    if (buckets == 0) {
+        return QVector<QPointF>() << points.first() << points.last();
+    }
+    double every = double(count - 2) / buckets;
+    QVector<QPointF> sampled;
+    sampled.reserve(buckets * 2 + 2);
+    sampled.append(points.first());
+    for (int bucket = 0; bucket < buckets; ++bucket) {
+        int start = int(std::floor(bucket * every)) + 1;
+        int end = qMin(int(std::floor((bucket + 1) * every)) + 1, count - 1);
+        if (start >= end) {
+            continue;
+        }
+        int low = start;
+        int high = start;
+        for (int i = start + 1; i < end; ++i) {
+            if (points[i].y() < points[low].y()) {
+                low = i;
+            }
+            if (points[i].y() > points[high].y()) {
+                high = i;
+            }
+        }
+        sampled.append(points[qMin(low, high)]);
+        if (low != high) {
+            sampled.append(points[qMax(low, high)]);
+        }
+    }
+    sampled.append(points.last());
+    return sampled;
+}
+
+QVector<QPointF> Downsampling::downsample(Method method, const QVector<QPointF> &points, int threshold)
+{
+    return method == Method::MinMax ? minMax(points, threshold) : lttb(points, threshold);
+}
+
+QVector<QPointF> Downsampling::window(const QVector<QPointF> &points, qreal minX, qreal maxX)
+{
+    auto byX = [](const QPointF &point, qreal x) { return point.x() < x; };
+    auto first = std::lower_bound(points.constBegin(), points.constEnd(), minX, byX);
+    auto last = std::upper_bound(points.constBegin(), points.constEnd(), maxX,
+                                 [](qreal x, const QPointF &point) { return x < point.x(); });
+    if (first != points.constBegin()) {
+        --first;
+    }
+    if (last != points.constEnd()) {
+        ++last;
+    }
+    QVector<QPointF> result;
+    result.reserve(int(last - first));
+    for (auto it = first; it != last; ++it) {
+        result.append(*it);
+    }
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef DOWNSAMPLING_H
+#define DOWNSAMPLING_H
+
+#include <QPointF>
+#include <QVector>
+
+// Прореживание временных рядов перед отрисовкой. Точки должны быть
+// упорядочены по x. Результат — подмножество исходных точек, поэтому
+// значения на диаграмме не искажаются. Ряд не длиннее threshold и
+// threshold < 2 возвращаются без изменений, при threshold 2 остаются
+// первая и последняя точки
+namespace Downsampling
+{
+
+enum class Method { Lttb, MinMax };
+
+// Largest-Triangle-Three-Buckets: первая и последняя точки плюс по одной
+// точке на корзину, дающей наибольший треугольник с соседями. Сохраняет
+// форму ряда при threshold точках
+QVector<QPointF> lttb(const QVector<QPointF> &points, int threshold);
+
+// Огибающая: минимум и максимум каждой корзины в порядке x, не больше
+// threshold точек. Пики не теряются, подходит для зашумлённых рядов
+QVector<QPointF> minMax(const QVector<QPointF> &points, int threshold);
+
+QVector<QPointF> downsample(Method method, const QVector<QPointF> &points, int threshold);
+
+// Точки с x в [minX, maxX] и по одной соседней с каждой стороны, чтобы
+// линия доходила до краёв окна
+QVector<QPointF> window(const QVector<QPointF> &points, qreal minX, qreal maxX);
+
+} // namespace Downsampling
+
+#endif // DOWNSAMPLING_H
@@ -0,0 +1,423 @@
+#include "exportwriters.h"
+#include <QHash>
+#include <QTextCodec>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+
+// Минимальный построитель flatbuffers для метаданных Arrow. Объекты пишутся
+// вперёд, ссылки (uoffset) всегда указывают на более поздние объекты и
+// заполняются после записи цели
+class FlatBuilder
+{
+public:
+    // Поле таблицы: скаляр размера size или ссылка на объект
+    struct Slot
+    {
+        int id;
+        int size;
+        qint64 value;
+        bool reference;
+    };
+
+    FlatBuilder()
+    {
+        putScalar(0, 4); // ссылка на корневую таблицу
+    }
+
+    int table(const QVector<Slot> &slots, QHash<int, int> *references = nullptr)
+    {
+        int maxId = -1;
+        bool wide = false;
+        for (const Slot &slot : slots) {
+            maxId = qMax(maxId, slot.id);
+            wide = wide || (!slot.reference && slot.size == 8);
+        }
+
+        align(2);
+        int vtable = data.size();
+        int vtableSize = 4 + 2 * (maxId + 1);
+        data.append(QByteArray(vtableSize, 0));
+
+        align(wide ? 8 : 4);
+        int start = data.size();
+        putScalar(start - vtable, 4);
+        for (const Slot &slot : slots) {
+            int size = slot.reference ? 4 : slot.size;
+            align(size);
+            setUInt16(vtable + 4 + 2 * slot.id, data.size() - start);
+            if (slot.reference) {
+                references->insert(slot.id, data.size());
+                putScalar(0, 4);
+            } else {
+                putScalar(slot.value, size);
+            }
+        }
+        setUInt16(vtable, vtableSize);
+        setUInt16(vtable + 2, data.size() - start);
+        return start;
+    }
+
+    // Вектор структур из 64-битных полей (FieldNode, Buffer)
+    int longVector(const QVector<qint64> &values, int fieldsPerElement)
+    {
+        // Элементы выравниваются по 8 байт, длина стоит перед ними
+        while (data.size() % 8 != 4) {
+            data.append('\0');
+        }
+        int start = data.size();
+        putScalar(values.size() / fieldsPerElement, 4);
+        for (qint64 value : values) {
+            putScalar(value, 8);
+        }
+        return start;
+    }
+
+    // Вектор ссылок; позиции ссылок возвращаются для заполнения
+    int referenceVector(int count, QVector<int> *positions)
+    {
+        align(4);
+        int start = data.size();
+        putScalar(count, 4);
+        for (int i = 0; i < count; ++i) {
+            positions->append(data.size());
+            putScalar(0, 4);
+        }
+        return start;
+    }
+
+    int string(const QByteArray &value)
+    {
+        align(4);
+        int start = data.size();
+        putScalar(value.size(), 4);
+        data.append(value);
+        data.append('\0');
+        return start;
+    }
+
+    void patch(int position, int target)
+    {
+        quint32 offset = quint32(target - position);
+        std::memcpy(data.data() + position, &offset, 4);
+    }
+
+    QByteArray finish(int root)
+    {
+        patch(0, root);
+        align(8);
+        return data;
+    }
+
+private:
+    void align(int size)
+    {
+        while (data.size() % size != 0) {
+            data.append('\0');
+        }
+    }
+
+    void putScalar(qint64 value, int size)
+    {
+        // Формат little-endian, как и поддерживаемые платформы
+        data.append(reinterpret_cast<const char *>(&value), size);
+    }
+
+    void setUInt16(int position, int value)
+    {
+        quint16 field = quint16(value);
+        std::memcpy(data.data() + position, &field, 2);
+    }
+
+    QByteArray data;
+};
+
+// Значения перечислений из Schema.fbs и Message.fbs
+const int MetadataV5 = 4;
+const int HeaderSchema = 1;
+const int HeaderRecordBatch = 3;
+const int TypeInt = 2;
+const int TypeFloatingPoint = 3;
+const int TypeUtf8 = 5;
+const int PrecisionDouble = 2;
+
+void padTo8(QByteArray *bytes)
+{
+    while (bytes->size() % 8 != 0) {
+        bytes->append('\0');
+    }
+}
+
+// Целое без потери точности; false, если значение не целое
+bool exactInt64(const QVariant &value, qint64 *number)
+{
+    switch (value.type()) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+        *number = value.toLongLong();
+        return true;
+    case QVariant::ULongLong:
+        *number = qint64(value.toULongLong());
+        return *number >= 0;
+    case QVariant::Double: {
+        double real = value.toDouble();
+        *number = qint64(real);
+        return std::floor(real) == real && std::fabs(real) < 9.2e18;
+    }
+    default: {
+        bool ok = false;
+        *number = value.toString().toLongLong(&ok);
+        return ok;
+    }
+    }
+}
+
+} // namespace
+
+CsvWriter::CsvWriter(QIODevice *device, QChar separator)
+    : stream(device)
+    , separator(separator)
+{
+    stream.setCodec(QTextCodec::codecForName("UTF-8"));
+}
+
+bool CsvWriter::begin(const QStringList &columns, const QVector<QVariant::Type> &types)
+{
+    Q_UNUSED(types);
+    for (int col = 0; col < columns.size(); ++col) {
+        if (col > 0) {
+            stream << separator;
+        }
+        writeField(columns[col]);
+    }
+    stream << "\r\n";
+    return check();
+}
+
+bool CsvWriter::writeRow(const QVector<QVariant> &values)
+{
+    for (int col = 0; col < values.size(); ++col) {
+        if (col > 0) {
+            stream << separator;
+        }
+        if (!values[col].isNull()) {
+            writeField(values[col].toString());
+        }
+    }
+    stream << "\r\n";
+    return check();
+}
+
+bool CsvWriter::finish()
+{
+    stream.flush();
+    return check();
+}
+
+void CsvWriter::writeField(const QString &value)
+{
+    bool quoted = value.contains(separator) || value.contains('"') || value.contains('\n') || value.contains('\r');
+    if (!quoted) {
+        stream << value;
+        return;
+    }
+    QString escaped = value;
+    escaped.replace("\"", "\"\"");
+    stream << '"' << escaped << '"';
+}
+
+bool CsvWriter::check()
+{
+    if (stream.status() == QTextStream::Ok) {
+        return true;
+    }
+    error = stream.device()->errorString();
+    return false;
+}
+
+ArrowStreamWriter::ArrowStreamWriter(QIODevice *device, int batchRows)
+    : device(device)
+    , batchRows(qMax(1, batchRows))
+    , rows(0)
+{
+}
+
+bool ArrowStreamWriter::begin(const QStringList &names, const QVector<QVariant::Type> &types)
+{
+    columns.clear();
+    for (int col = 0; col < names.size(); ++col) {
+        QVariant::Type type = types.value(col, QVariant::Invalid);
+        Kind kind = Kind::Utf8;
+        if (type == QVariant::Int || type == QVariant::LongLong || type == QVariant::UInt
+                || type == QVariant::ULongLong || type == QVariant::Bool) {
+            kind = Kind::Int64;
+        } else if (type == QVariant::Double) {
+            kind = Kind::Float64;
+        }
+        columns.append(Column{names[col], kind, QByteArray(), QByteArray(), QByteArray(), 0});
+    }
+
+    // Message { version, header: Schema { fields: [Field { name, nullable, type, children }] } }
+    FlatBuilder builder;
+    QHash<int, int> messageRefs;
+    int message = builder.table({{0, 2, MetadataV5, false}, {1, 1, HeaderSchema, false}, {2, 4, 0, true}},
+                                &messageRefs);
+    QHash<int, int> schemaRefs;
+    int schema = builder.table({{1, 4, 0, true}}, &schemaRefs);
+    builder.patch(messageRefs.value(2), schema);
+
+    QVector<int> fieldRefs;
+    builder.patch(schemaRefs.value(1), builder.referenceVector(columns.size(), &fieldRefs));
+    for (int col = 0; col < columns.size(); ++col) {
+        int typeId = columns[col].kind == Kind::Int64 ? TypeInt
+                   : columns[col].kind == Kind::Float64 ? TypeFloatingPoint : TypeUtf8;
+        QHash<int, int> refs;
+        int field = builder.table({{0, 4, 0, true}, {1, 1, 1, false}, {2, 1, typeId, false},
+                                   {3, 4, 0, true}, {5, 4, 0, true}}, &refs);
+        builder.patch(fieldRefs[col], field);
+        builder.patch(refs.value(0), builder.string(columns[col].name.toUtf8()));
+
+        int typeTable;
+        if (columns[col].kind == Kind::Int64) {
+            typeTable = builder.table({{0, 4, 64, false}, {1, 1, 1, false}});
+        } else if (columns[col].kind == Kind::Float64) {
+            typeTable = builder.table({{0, 2, PrecisionDouble, false}});
+        } else {
+            typeTable = builder.table({});
+        }
+        builder.patch(refs.value(3), typeTable);
+
+        QVector<int> noChildren;
+        builder.patch(refs.value(5), builder.referenceVector(0, &noChildren));
+    }
+    return writeMessage(builder.finish(message), QByteArray());
+}
+
+bool ArrowStreamWriter::writeRow(const QVector<QVariant> &values)
+{
+    for (int col = 0; col < columns.size(); ++col) {
+        Column &column = columns[col];
+        const QVariant &value = values.value(col);
+        bool valid = !value.isNull();
+
+        // Значение должно помещаться в тип столбца из схемы
+        qint64 integer = 0;
+        double real = 0.0;
+        bool fits = true;
+        if (valid && column.kind == Kind::Int64) {
+            fits = exactInt64(value, &integer);
+        } else if (valid && column.kind == Kind::Float64) {
+            real = value.toDouble(&fits);
+        }
+        if (!fits) {
+            error = QString("Column %1: value \"%2\" does not fit %3")
+                        .arg(column.name, value.toString(), column.kind == Kind::Int64 ? "Int64" : "Float64");
+            return false;
+        }
+
+        if (rows % 8 == 0) {
+            column.validity.append('\0');
+        }
+        if (valid) {
+            column.validity[rows / 8] = char(column.validity[rows / 8] | (1 << (rows % 8)));
+        } else {
+            ++column.nullCount;
+        }
+
+        switch (column.kind) {
+        case Kind::Int64:
+            column.values.append(reinterpret_cast<const char *>(&integer), 8);
+            break;
+        case Kind::Float64:
+            column.values.append(reinterpret_cast<const char *>(&real), 8);
+            break;
+        case Kind::Utf8: {
+            if (column.values.isEmpty()) {
+                qint32 zero = 0;
+                column.values.append(reinterpret_cast<const char *>(&zero), 4);
+            }
+            if (valid) {
+                column.strings.append(value.toString().toUtf8());
+            }
+            qint32 end = column.strings.size();
+            column.values.append(reinterpret_cast<const char *>(&end), 4);
+            break;
+        }
+        }
+    }
+
+    ++rows;
+    return rows < batchRows || flush();
+}
+
+bool ArrowStreamWriter::finish()
+{
+    if (rows > 0 && !flush()) {
+        return false;
+    }
+    // Маркер конца потока: продолжение и нулевая длина метаданных
+    const char end[8] = {'\xff', '\xff', '\xff', '\xff', 0, 0, 0, 0};
+    if (device->write(end, sizeof(end)) != qint64(sizeof(end))) {
+        error = device->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ArrowStreamWriter::flush()
+{
+    // Тело: буферы столбцов подряд, каждый выровнен по 8 байт. Битовая
+    // маска пропускается, если в столбце нет NULL
+    QByteArray body;
+    QVector<qint64> nodes;
+    QVector<qint64> buffers;
+    auto addBuffer = [&body, &buffers](const QByteArray &bytes) {
+        buffers << body.size() << bytes.size();
+        body.append(bytes);
+        padTo8(&body);
+    };
+    for (Column &column : columns) {
+        nodes << rows << column.nullCount;
+        addBuffer(column.nullCount > 0 ? column.validity : QByteArray());
+        addBuffer(column.values);
+        if (column.kind == Kind::Utf8) {
+            addBuffer(column.strings);
+        }
+        column.validity.clear();
+        column.values.clear();
+        column.strings.clear();
+        column.nullCount = 0;
+    }
+
+    // Message { version, header: RecordBatch { length, nodes, buffers }, bodyLength }
+    FlatBuilder builder;
+    QHash<int, int> messageRefs;
+    int message = builder.table({{0, 2, MetadataV5, false}, {1, 1, HeaderRecordBatch, false},
+                                 {2, 4, 0, true}, {3, 8, body.size(), false}}, &messageRefs);
+    QHash<int, int> batchRefs;
+    int batch = builder.table({{0, 8, rows, false}, {1, 4, 0, true}, {2, 4, 0, true}}, &batchRefs);
+    builder.patch(messageRefs.value(2), batch);
+    builder.patch(batchRefs.value(1), builder.longVector(nodes, 2));
+    builder.patch(batchRefs.value(2), builder.longVector(buffers, 2));
+
+    rows = 0;
+    return writeMessage(builder.finish(message), body);
+}
+
+bool ArrowStreamWriter::writeMessage(const QByteArray &metadata, const QByteArray &body)
+{
+    // Инкапсуляция сообщения: 0xFFFFFFFF, длина метаданных, метаданные, тело
+    QByteArray prefix(8, '\xff');
+    qint32 length = metadata.size();
+    std::memcpy(prefix.data() + 4, &length, 4);
+    if (device->write(prefix) != prefix.size() || device->write(metadata) != metadata.size()
+            || device->write(body) != body.size()) {
+        error = device->errorString();
+        return false;
+    }
+    return true;
+}
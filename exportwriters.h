@@ -0,0 +1,83 @@
+#ifndef EXPORTWRITERS_H
+#define EXPORTWRITERS_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QStringList>
+#include <QTextStream>
+#include <QVariant>
+#include <QVector>
+
+// Потоковая запись строк отчёта в файл. Строки не накапливаются: CSV
+// пишется построчно, Arrow — пакетами фиксированного размера, поэтому
+// память не зависит от размера отчёта
+class ExportWriter
+{
+public:
+    virtual ~ExportWriter() {}
+
+    // types — типы столбцов из описания результата (QVariant::Invalid, если неизвестен)
+    virtual bool begin(const QStringList &columns, const QVector<QVariant::Type> &types) = 0;
+    virtual bool writeRow(const QVector<QVariant> &values) = 0;
+    virtual bool finish() = 0;
+
+    QString errorString() const { return error; }
+
+protected:
+    QString error;
+};
+
+// CSV по RFC 4180: заголовок, NULL — пустое поле, кавычки только при необходимости
+class CsvWriter : public ExportWriter
+{
+public:
+    explicit CsvWriter(QIODevice *device, QChar separator = ',');
+
+    bool begin(const QStringList &columns, const QVector<QVariant::Type> &types) override;
+    bool writeRow(const QVector<QVariant> &values) override;
+    bool finish() override;
+
+private:
+    void writeField(const QString &value);
+    bool check();
+
+    QTextStream stream;
+    QChar separator;
+};
+
+// Потоковый формат Arrow IPC (schema, record batch..., конец потока).
+// Целые столбцы — Int64, вещественные — Float64, остальные — Utf8.
+// Значение, которое не помещается в тип столбца без потерь (дробное в
+// Int64, текст в Float64), прерывает запись с ошибкой
+class ArrowStreamWriter : public ExportWriter
+{
+public:
+    explicit ArrowStreamWriter(QIODevice *device, int batchRows = 65536);
+
+    bool begin(const QStringList &columns, const QVector<QVariant::Type> &types) override;
+    bool writeRow(const QVector<QVariant> &values) override;
+    bool finish() override;
+
+private:
+    enum class Kind { Int64, Float64, Utf8 };
+
+    struct Column
+    {
+        QString name;
+        Kind kind;
+        QByteArray validity;
+        QByteArray values;   // Int64/Float64 или смещения Utf8 (int32)
+        QByteArray strings;  // данные Utf8
+        int nullCount;
+    };
+
+    bool flush();
+    bool writeMessage(const QByteArray &metadata, const QByteArray &body);
+
+    QIODevice *device;
+    int batchRows;
+    int rows;
+    QVector<Column> columns;
+};
+
+#endif // EXPORTWRITERS_H
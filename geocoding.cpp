@@ -0,0 +1,101 @@
+#include "geocoding.h"
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QDebug>
+
+namespace
+{
+
+const char *const GeocodingResource = ":/geocoding.csv";
+
+Geocoding loadDefault()
+{
+    Geocoding geocoding;
+    QString error;
+    if (!geocoding.load(GeocodingResource, &error)) {
+        qDebug() << "Geocoding load error:" << error;
+    }
+    return geocoding;
+}
+
+} // namespace
+
+const Geocoding &Geocoding::instance()
+{
+    // Инициализация локальной статической переменной потокобезопасна
+    static const Geocoding geocoding = loadDefault();
+    return geocoding;
+}
+
+QString Geocoding::makeKey(const QString &country, const QString &city)
+{
+    QString key = country.trimmed().toCaseFolded();
+    if (!city.isEmpty()) {
+        key += QChar(0x1f) + city.trimmed().toCaseFolded();
+    }
+    return key;
+}
+
+bool Geocoding::load(const QString &fileName, QString *error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    // Строка: вид;страна;город;широта;долгота. Для вида country город пуст
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    int lineNumber = 0;
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        ++lineNumber;
+        if (line.trimmed().isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        QStringList fields = line.split(';');
+        bool latitudeOk = false;
+        bool longitudeOk = false;
+        GeoPoint point;
+        if (fields.size() == 5) {
+            point.latitude = fields[3].toDouble(&latitudeOk);
+            point.longitude = fields[4].toDouble(&longitudeOk);
+        }
+        if (!latitudeOk || !longitudeOk) {
+            qDebug() << "Geocoding: bad line" << lineNumber << "in" << fileName;
+            continue;
+        }
+
+        if (fields[0] == "country") {
+            points.insert(makeKey(fields[1]), point);
+        } else if (fields[0] == "city" && !fields[2].trimmed().isEmpty()) {
+            points.insert(makeKey(fields[1], fields[2]), point);
+        }
+    }
+    return true;
+}
+
+bool Geocoding::country(const QString &name, GeoPoint *point) const
+{
+    auto it = points.constFind(makeKey(name));
+    if (it == points.constEnd()) {
+        return false;
+    }
+    *point = it.value();
+    return true;
+}
+
+bool Geocoding::city(const QString &country, const QString &city, GeoPoint *point) const
+{
+    auto it = points.constFind(makeKey(country, city));
+    if (it == points.constEnd()) {
+        return false;
+    }
+    *point = it.value();
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef GEOCODING_H
+#define GEOCODING_H
+
+#include <QHash>
+#include <QString>
+
+struct GeoPoint
+{
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+// Таблица координат стран и городов. Загружается один раз из CSV
+// (по умолчанию ресурс :/geocoding.csv) в плоский хэш; названия
+// сравниваются без учёта регистра и пробелов по краям, как они
+// встречаются в BillingCountry и BillingCity
+class Geocoding
+{
+public:
+    static const Geocoding &instance();
+
+    bool load(const QString &fileName, QString *error = nullptr);
+
+    bool country(const QString &name, GeoPoint *point) const;
+    bool city(const QString &country, const QString &city, GeoPoint *point) const;
+
+    int size() const { return points.size(); }
+
+private:
+    static QString makeKey(const QString &country, const QString &city = QString());
+
+    QHash<QString, GeoPoint> points; // "страна" или "страна\x1fгород" -> координаты
+};
+
+#endif // GEOCODING_H
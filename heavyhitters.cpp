@@ -0,0 +1,159 @@
+#include "heavyhitters.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// splitmix64: независимые хеши для строк Count-Min по разным затравкам
+quint64 mix(quint64 value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+} // namespace
+
+SpaceSaving::SpaceSaving(int capacity)
+    : maxCounters(qMax(1, capacity))
+    , totalWeight(0)
+{
+    heap.reserve(maxCounters);
+}
+
+void SpaceSaving::clear()
+{
+    heap.clear();
+    positions.clear();
+    totalWeight = 0;
+}
+
+void SpaceSaving::add(quint64 key, qint64 weight)
+{
+    totalWeight += weight;
+
+    auto it = positions.constFind(key);
+    if (it != positions.constEnd()) {
+        int index = it.value();
+        heap[index].count += weight;
+        siftDown(index);
+        return;
+    }
+
+    if (heap.size() < maxCounters) {
+        heap.append({key, weight, 0});
+        positions.insert(key, heap.size() - 1);
+        siftUp(heap.size() - 1);
+        return;
+    }
+
+    // Вытесняем минимальный счётчик; его значение — погрешность нового
+    Counter &victim = heap[0];
+    positions.remove(victim.key);
+    victim.error = victim.count;
+    victim.count += weight;
+    victim.key = key;
+    positions.insert(key, 0);
+    siftDown(0);
+}
+
+qint64 SpaceSaving::maxError() const
+{
+    // Пока счётчики не заполнены, вытеснений не было
+    return heap.size() < maxCounters ? 0 : heap.first().count;
+}
+
+QVector<SpaceSaving::Counter> SpaceSaving::top(int n) const
+{
+    QVector<Counter> sorted = heap;
+    int count = qMin(n, sorted.size());
+    // Порядок равных счётчиков в куче зависит от истории вставок,
+    // поэтому граница top-n определяется ещё и ключом
+    std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(), [](const Counter &a, const Counter &b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    sorted.resize(count);
+    return sorted;
+}
+
+void SpaceSaving::swapCounters(int a, int b)
+{
+    std::swap(heap[a], heap[b]);
+    positions[heap[a].key] = a;
+    positions[heap[b].key] = b;
+}
+
+void SpaceSaving::siftUp(int index)
+{
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (heap[parent].count <= heap[index].count) {
+            break;
+        }
+        swapCounters(parent, index);
+        index = parent;
+    }
+}
+
+void SpaceSaving::siftDown(int index)
+{
+    for (;;) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        if (left < heap.size() && heap[left].count < heap[smallest].count) {
+            smallest = left;
+        }
+        if (right < heap.size() && heap[right].count < heap[smallest].count) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        swapCounters(smallest, index);
+        index = smallest;
+    }
+}
+
+CountMinSketch::CountMinSketch(int width, int depth)
+    : width(qMax(1, width))
+    , depth(qMax(1, depth))
+    , totalWeight(0)
+    , counters(this->width * this->depth, 0)
+{
+}
+
+int CountMinSketch::column(int row, quint64 key) const
+{
+    return int(mix(key ^ mix(quint64(row) + 1)) % quint64(width));
+}
+
+void CountMinSketch::add(quint64 key, qint64 weight)
+{
+    totalWeight += weight;
+    for (int row = 0; row < depth; ++row) {
+        counters[row * width + column(row, key)] += weight;
+    }
+}
+
+qint64 CountMinSketch::estimate(quint64 key) const
+{
+    qint64 best = counters[column(0, key)];
+    for (int row = 1; row < depth; ++row) {
+        best = qMin(best, counters[row * width + column(row, key)]);
+    }
+    return best;
+}
+
+void CountMinSketch::clear()
+{
+    counters.fill(0);
+    totalWeight = 0;
+}
+
+double CountMinSketch::errorBound() const
+{
+    return std::exp(1.0) / width * totalWeight;
+}
@@ -0,0 +1,73 @@
+#ifndef HEAVYHITTERS_H
+#define HEAVYHITTERS_H
+
+#include <QHash>
+#include <QVector>
+
+// Потоковые скетчи частых элементов с ограниченной памятью. Ключ —
+// целочисленный идентификатор, вес — неотрицательное количество
+
+// Space-Saving: не больше capacity счётчиков. Если элемента нет, а места
+// нет, вытесняется счётчик с наименьшим значением, и новый элемент
+// наследует его значение как погрешность. Для каждого счётчика
+// count - error <= истинная сумма <= count; любой элемент с суммой
+// больше total / capacity гарантированно присутствует
+class SpaceSaving
+{
+public:
+    struct Counter
+    {
+        quint64 key;
+        qint64 count;
+        qint64 error;
+    };
+
+    explicit SpaceSaving(int capacity = 64);
+
+    void add(quint64 key, qint64 weight = 1);
+    void clear();
+
+    int capacity() const { return maxCounters; }
+    qint64 total() const { return totalWeight; }
+    // Наибольшая возможная переоценка любого счётчика
+    qint64 maxError() const;
+
+    // Счётчики по убыванию count, при равенстве — по возрастанию ключа
+    QVector<Counter> top(int n) const;
+
+private:
+    void siftDown(int index);
+    void siftUp(int index);
+    void swapCounters(int a, int b);
+
+    int maxCounters;
+    qint64 totalWeight;
+    QVector<Counter> heap;          // min-куча по count
+    QHash<quint64, int> positions;  // ключ -> индекс в куче
+};
+
+// Count-Min: depth строк по width счётчиков. Оценка не меньше истинной
+// и с вероятностью 1 - exp(-depth) превышает её не больше чем на
+// e / width * total
+class CountMinSketch
+{
+public:
+    explicit CountMinSketch(int width = 256, int depth = 4);
+
+    void add(quint64 key, qint64 weight = 1);
+    qint64 estimate(quint64 key) const;
+    void clear();
+
+    qint64 total() const { return totalWeight; }
+    double errorBound() const;
+
+private:
+    int column(int row, quint64 key) const;
+
+    int width;
+    int depth;
+    qint64 totalWeight;
+    QVector<qint64> counters; // depth * width
+};
+
+#endif // HEAVYHITTERS_H
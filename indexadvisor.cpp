@@ -0,0 +1,135 @@
+#include "indexadvisor.h"
+#include "reports.h"
+#include "statementregistry.h"
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+namespace
+{
+
+struct IndexCandidate
+{
+    const char *name;
+    const char *sql;
+};
+
+// Группировка по месяцу и по стране читается из индексов, а строки
+// счетов — из покрывающих индексов без обращения к таблице
+const IndexCandidate candidates[] = {
+    {"idx_invoices_month",
+     "CREATE INDEX IF NOT EXISTS idx_invoices_month ON invoices (strftime('%Y-%m', InvoiceDate))"},
+    {"idx_invoices_country",
+     "CREATE INDEX IF NOT EXISTS idx_invoices_country ON invoices (BillingCountry)"},
+    {"idx_invoice_items_sales",
+     "CREATE INDEX IF NOT EXISTS idx_invoice_items_sales ON invoice_items (InvoiceId, TrackId, Quantity, UnitPrice)"},
+    {"idx_invoice_items_track_sales",
+     "CREATE INDEX IF NOT EXISTS idx_invoice_items_track_sales ON invoice_items (TrackId, Quantity, UnitPrice)"}
+};
+
+const int TimingRuns = 3;
+
+} // namespace
+
+QStringList IndexAdvisor::planProblems(QSqlDatabase &db, const QString &sql)
+{
+    QStringList problems;
+    QSqlQuery query(db);
+    if (!query.exec("EXPLAIN QUERY PLAN " + sql)) {
+        problems << "EXPLAIN failed: " + query.lastError().text();
+        return problems;
+    }
+    while (query.next()) {
+        // Столбцы плана: id, parent, notused, detail
+        QString detail = query.value(3).toString();
+        bool fullScan = detail.startsWith("SCAN ") && !detail.contains(" USING ");
+        if (fullScan || detail.contains("TEMP B-TREE")) {
+            problems << detail;
+        }
+    }
+    return problems;
+}
+
+double IndexAdvisor::bestTimeMs(QSqlDatabase &db, const QString &sql)
+{
+    double best = -1.0;
+    for (int run = 0; run < TimingRuns; ++run) {
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        QElapsedTimer timer;
+        timer.start();
+        if (!query.prepare(sql)) {
+            return -1.0;
+        }
+        QVariantMap params = Reports::defaultParams();
+        for (const QString &placeholder : StatementRegistry::placeholders(sql)) {
+            query.bindValue(placeholder, params.value(placeholder));
+        }
+        if (!query.exec()) {
+            return -1.0;
+        }
+        while (query.next()) {
+        }
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+IndexAdvice IndexAdvisor::analyze(QSqlDatabase &db)
+{
+    IndexAdvice advice;
+    for (const ReportDefinition &report : Reports::all()) {
+        for (const QString &problem : planProblems(db, report.sql)) {
+            advice.findings << report.name + ": " + problem;
+        }
+    }
+    if (advice.findings.isEmpty()) {
+        return advice;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'index' AND name = :name");
+    for (const IndexCandidate &candidate : candidates) {
+        query.bindValue(":name", candidate.name);
+        if (query.exec() && !query.next()) {
+            advice.statements << candidate.sql;
+        }
+    }
+    return advice;
+}
+
+QStringList IndexAdvisor::apply(QSqlDatabase &db, const QStringList &statements)
+{
+    QStringList log;
+    QList<ReportDefinition> reports = Reports::all();
+
+    QVector<double> before;
+    for (const ReportDefinition &report : reports) {
+        before.append(bestTimeMs(db, report.sql));
+    }
+
+    QSqlQuery query(db);
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            log << "Index error: " + query.lastError().text();
+        }
+    }
+    // Статистика для планировщика по новым индексам
+    query.exec("ANALYZE");
+
+    for (int i = 0; i < reports.size(); ++i) {
+        double after = bestTimeMs(db, reports[i].sql);
+        log << QString("%1: %2 ms -> %3 ms")
+                   .arg(reports[i].name)
+                   .arg(before[i], 0, 'f', 2)
+                   .arg(after, 0, 'f', 2);
+    }
+    for (const QString &line : log) {
+        qDebug() << "Index advisor:" << line;
+    }
+    return log;
+}
@@ -0,0 +1,35 @@
+#ifndef INDEXADVISOR_H
+#define INDEXADVISOR_H
+
+#include <QMetaType>
+#include <QSqlDatabase>
+#include <QStringList>
+
+// Итог анализа планов: найденные полные сканирования и временные B-деревья
+// и индексы, которых не хватает отчётам
+struct IndexAdvice
+{
+    QStringList findings;   // "monthly-sales: SCAN invoices"
+    QStringList statements; // CREATE INDEX для отсутствующих индексов
+};
+
+Q_DECLARE_METATYPE(IndexAdvice)
+
+// Советник по индексам. Прогоняет EXPLAIN QUERY PLAN для SQL всех отчётов
+// и предлагает покрывающие индексы и индексы по выражениям под их
+// группировки и соединения
+class IndexAdvisor
+{
+public:
+    static IndexAdvice analyze(QSqlDatabase &db);
+
+    // Создаёт индексы и замеряет каждый отчёт до и после.
+    // Возвращает строки журнала с временами и ошибками
+    static QStringList apply(QSqlDatabase &db, const QStringList &statements);
+
+private:
+    static QStringList planProblems(QSqlDatabase &db, const QString &sql);
+    static double bestTimeMs(QSqlDatabase &db, const QString &sql);
+};
+
+#endif // INDEXADVISOR_H
@@ -1,10 +1,25 @@
+#include "batchexport.h"
 #include "mainwindow.h"
+#include "storageconfig.h"
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
+    // Пакетная выгрузка отчёта: без окон и без QApplication
+    if (BatchExport::requested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return BatchExport::run(app.arguments());
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+
+    // Настройки хранилища из файла и командной строки; прочие ключи
+    // (например, ключи Qt) пропускаются
+    QCommandLineParser parser;
+    StorageConfig::addOptions(&parser);
+    parser.parse(a.arguments());
+    MainWindow w(StorageConfig::fromParser(parser));
     w.show();
 
     return a.exec();
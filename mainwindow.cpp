@@ -1,285 +1,563 @@
 #include "mainwindow.h"
+#include "tracing.h"
 #include "zoomablegraphicsview.h"
 #include "ui_mainwindow.h"
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QDebug>
-#include <QStandardItemModel>
-#include <QGraphicsEllipseItem>
+#include <QHeaderView>
 #include <QGraphicsTextItem>
-#include <QPixmap>
-#include <QGraphicsPixmapItem>
+#include <QLabel>
+#include <QActionGroup>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QElapsedTimer>
+#include <QSignalBlocker>
 #include <cmath>
 
-QMap<QString, QPointF> countryCoordinates = {
-    {"Belgium", QPointF(500, 110)},
-    {"Chile", QPointF(290, 360)},
-    {"Denmark", QPointF(505, 92)},
-    {"Italy", QPointF(516, 144)},
-    {"Norway", QPointF(507, 73)},
-    {"Sweden", QPointF(522, 73)},
-    {"Spain", QPointF(472, 148)},
-    {"USA", QPointF(200, 150)},
-    {"Canada", QPointF(200, 80)},
-    {"Mexico", QPointF(215, 205)},
-    {"Brazil", QPointF(350, 300)},
-    {"Argentina", QPointF(300, 350)},
-    {"UK", QPointF(480, 100)},
-    {"Germany", QPointF(510, 110)},
-    {"China", QPointF(750, 170)},
-    {"India", QPointF(690, 200)},
-    {"Australia", QPointF(840, 320)},
-    {"South Africa", QPointF(543, 343)},
-    {"Japan", QPointF(850, 158)},
-    {"Egypt", QPointF(559, 188)},
-    {"France", QPointF(488, 131)}
-};
-
-
-
-void MainWindow::displayMapSum(QMap<QString, QMap<QString, double>> &data)
+void MainWindow::displayMapSum(const QVector<CitySales> &rows)
 {
-    QGraphicsScene *scene = new QGraphicsScene(this);
-
-    // Загрузка фоновой карты
-    QPixmap mapPixmap("C:\\Qt\\Qt5.12.2\\Projects\\SalesAnalytics\\world_map.png");
-    QGraphicsPixmapItem *mapItem = scene->addPixmap(mapPixmap);
-    mapItem->setZValue(-1); // Фон на задний план
-
-    // Расставляем страны
-    for (const auto &country : data.keys()) {
-        if (!countryCoordinates.contains(country)) {
-            qDebug() << "Missing coordinates for country:" << country;
+    TRACE_SCOPE("displayMapSum");
+    // Города с суммой продаж; близкие точки объединяются в кластеры
+    // в зависимости от масштаба карты. Город без координат ставится
+    // в точку своей страны
+    QVector<MarkerClusters::Point> points;
+    QStringList countries;
+    for (const CitySales &row : rows) {
+        QPointF coords;
+        if (!mapScene->cityPosition(row.country, row.city, &coords)
+            && !mapScene->countryPosition(row.country, &coords)) {
             continue;
         }
-
-        QPointF coords = countryCoordinates[country];
-        const auto &genres = data[country];
-
-        // Считаем общий объём продаж
-        double totalSales = 0;
-        for (const auto &sales : genres.values()) {
-            totalSales += sales;
-        }
-
-        // Цвет и размер зависят от продаж
-        QColor color = QColor::fromHsv(0, 255, std::min(255.0, totalSales));
-        double radius = sqrt(totalSales)*2;
-
-        // Круг для страны
-        QGraphicsEllipseItem *circle = scene->addEllipse(
-            coords.x() - radius / 2, coords.y() - radius / 2,
-            radius, radius,
-            QPen(Qt::NoPen), QBrush(color)
-        );
-
-        // Текстовая подпись
-        QGraphicsTextItem *textItem = scene->addText(country);
-        textItem->setPos(coords.x() + radius / 2, coords.y() + radius / 2);
+        QString label = row.city.isEmpty() ? row.country : row.city;
+        points.append({coords, row.quantity, label});
+        countries.append(row.country);
     }
 
-    ui->graphicsView->setScene(scene);
+    // Цвет и размер зависят от продаж
+    mapScene->setClusteredMarkers(points, countries, [](double totalSales, qreal *diameter, QColor *color) {
+        *color = QColor::fromHsv(0, 255, int(std::min(255.0, totalSales)));
+        *diameter = sqrt(totalSales)*2;
+    });
+    mapScene->setLegend(QMap<QString, QColor>());
+
+    ui->graphicsView->setScene(mapScene);
+    ui->graphicsView->setMapRendering(true);
     ui->graphicsView->show();
 }
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const StorageConfig &storage, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , timeSalesShown(false)
 {
     ui->setupUi(this);
 
-    // Подключение к базе данных
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("C:\\Qt\\Qt5.12.2\\Projects\\SalesAnalytics\\chinook.db");
-    if (!db.open()) {
-        qDebug() << "Database error:" << db.lastError().text();
-        return;
+    // Запросы выполняются в отдельном потоке со своим соединением с базой данных
+    executor = new QueryExecutor(storage, this);
+    connect(executor, &QueryExecutor::busyChanged, this, [this](bool busy) {
+        if (busy) {
+            ui->statusBar->showMessage("Выполняется запрос...");
+        } else {
+            ui->statusBar->clearMessage();
+        }
+    });
+    connect(executor, &QueryExecutor::errorOccurred, this, [this](const QString &message) {
+        ui->statusBar->showMessage("Database error: " + message, 5000);
+    });
+
+    // Счётчики кэша результатов отчётов
+    QLabel *cacheLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(cacheLabel);
+    connect(executor, &QueryExecutor::cacheStatsChanged, cacheLabel, [cacheLabel](quint64 hits, quint64 misses) {
+        cacheLabel->setText(QString("Кэш: попаданий %1, промахов %2").arg(hits).arg(misses));
+    });
+
+    mapScene = new MapScene(this);
+    shapeScene = new QGraphicsScene(this);
+    connect(ui->graphicsView, &ZoomableGraphicsView::scaleChanged, mapScene, &MapScene::setViewScale);
+
+    // Диаграммы обновляются на месте; длинные линии можно всегда рисовать
+    // через OpenGL, иначе он включается по числу точек
+    chartUpdater = new ChartUpdater(ui->chartView, this);
+    QAction *openGLAction = ui->mainToolBar->addAction("OpenGL для линий");
+    openGLAction->setCheckable(true);
+    connect(openGLAction, &QAction::toggled, this, [this](bool checked) {
+        chartUpdater->setOpenGLMode(checked ? ChartUpdater::OpenGLMode::Always : ChartUpdater::OpenGLMode::Auto);
+    });
+    // Длинные ряды прореживаются по видимому окну: LTTB сохраняет форму,
+    // огибающая min/max — пики
+    QAction *envelopeAction = ui->mainToolBar->addAction("Огибающая min/max");
+    envelopeAction->setCheckable(true);
+    connect(envelopeAction, &QAction::toggled, this, [this](bool checked) {
+        chartUpdater->setDownsamplingMethod(checked ? Downsampling::Method::MinMax : Downsampling::Method::Lttb);
+    });
+
+    // Таблица: ширина столбцов оценивается по первой порции строк,
+    // высота строк фиксирована и не измеряется для каждой строки
+    tableModel = new ResultTableModel(this);
+    ui->tableView->setModel(tableModel);
+    ui->tableView->horizontalHeader()->setResizeContentsPrecision(ResultTableModel::FetchBatchSize);
+    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    // Трассировка горячих путей: разбивка времени отчёта в строке
+    // состояния и выгрузка событий для chrome://tracing
+    QAction *traceAction = ui->mainToolBar->addAction("Трассировка");
+    traceAction->setCheckable(true);
+    traceAction->setChecked(qEnvironmentVariableIsSet("SALESANALYTICS_TRACE"));
+    Tracing::setEnabled(traceAction->isChecked());
+    connect(traceAction, &QAction::toggled, this, [](bool checked) {
+        Tracing::setEnabled(checked);
+    });
+    QAction *saveTraceAction = ui->mainToolBar->addAction("Сохранить трассу...");
+    connect(saveTraceAction, &QAction::triggered, this, [this]() {
+        QString fileName = QFileDialog::getSaveFileName(this, "Сохранить трассу", "trace.json", "Chrome trace (*.json)");
+        if (fileName.isEmpty()) {
+            return;
+        }
+        QString error;
+        if (Tracing::exportChromeTrace(fileName, &error)) {
+            ui->statusBar->showMessage("Трасса сохранена: " + fileName, 5000);
+        } else {
+            ui->statusBar->showMessage("Не удалось сохранить трассу: " + error, 5000);
+        }
+    });
+
+    // Топ артистов по жанрам берётся из скетчей частых элементов; точный
+    // режим считает его SQL-отчётом для сверки
+    // Скетчи и движки, кроме SQL, работают по копии данных у клиента и
+    // доступны только для SQLite; PostgreSQL считает отчёты на сервере
+    bool localEngines = storage.dialect == SqlDialect::Sqlite;
+    QAction *exactTopKAction = ui->mainToolBar->addAction("Точный топ-K");
+    exactTopKAction->setCheckable(true);
+    exactTopKAction->setEnabled(localEngines);
+    connect(exactTopKAction, &QAction::toggled, this, [this](bool checked) {
+        executor->setApproximateTopK(!checked);
+    });
+
+    // Переключатель движка: SQL по базе, колоночные массивы в памяти
+    // или SQL по диапазонам счетов на всех ядрах
+    QActionGroup *engineGroup = new QActionGroup(this);
+    const QPair<QString, ExecutionEngine> engines[] = {
+        {"SQL", ExecutionEngine::Sql},
+        {"Колоночный движок", ExecutionEngine::Columnar},
+        {"Параллельный SQL", ExecutionEngine::Partitioned}
+    };
+    for (const auto &engine : engines) {
+        QAction *action = ui->mainToolBar->addAction(engine.first);
+        action->setCheckable(true);
+        action->setChecked(engine.second == ExecutionEngine::Sql);
+        action->setEnabled(localEngines);
+        engineGroup->addAction(action);
+        ExecutionEngine value = engine.second;
+        connect(action, &QAction::triggered, this, [this, value]() {
+            executor->setEngine(value);
+        });
     }
 
-    // Подключаем кнопки к слотам
-    connect(ui->btnMonthlySales, &QPushButton::clicked, this, &MainWindow::showMonthlySales);
-    connect(ui->btnMonthlySales, &QPushButton::clicked, this, &MainWindow::showMonthlySalesChart);
+    // При запуске планы отчётов проверяются на полные сканирования и
+    // временные B-деревья; недостающие индексы создаются с согласия пользователя
+    connect(executor, &QueryExecutor::indexAdviceReady, this, [this](const IndexAdvice &advice) {
+        if (advice.statements.isEmpty()) {
+            return;
+        }
+        QMessageBox box(QMessageBox::Question, "Индексы",
+                        QString("В планах отчётов найдено проблем: %1. Создать %2 индекс(ов)?")
+                            .arg(advice.findings.size())
+                            .arg(advice.statements.size()),
+                        QMessageBox::Yes | QMessageBox::No, this);
+        box.setDetailedText(advice.findings.join("\n") + "\n\n" + advice.statements.join(";\n"));
+        if (box.exec() == QMessageBox::Yes) {
+            ui->statusBar->showMessage("Создание индексов...");
+            executor->createIndexes(advice.statements);
+        }
+    });
+    connect(executor, &QueryExecutor::indexesCreated, this, [this](const QStringList &log) {
+        ui->statusBar->showMessage("Индексы созданы: " + log.join("; "), 10000);
+    });
+    executor->adviseIndexes();
+
+    // Перекрёстные фильтры: щелчок по стране на карте, сегменту диаграммы
+    // или ячейке таблицы фильтрует все представления. С фильтром отчёты
+    // считаются по срезам куба продаж, без повторных соединений в SQL
+    filterLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(filterLabel);
+    QAction *clearFilterAction = ui->mainToolBar->addAction("Сбросить фильтр");
+    connect(clearFilterAction, &QAction::triggered, this, [this]() {
+        filter = CrossFilter();
+        applyFilter();
+    });
+    connect(mapScene, &MapScene::countryClicked, this, &MainWindow::toggleCountryFilter);
+    connect(ui->tableView, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        const QueryResult &result = tableModel->result();
+        QString column = result.columns.value(index.column());
+        QString value = result.value(index.row(), index.column()).toString();
+        if (column == "BillingCountry" || column == "Country") {
+            toggleCountryFilter(value);
+        } else if (column == "GenreName" || column == "TopGenre") {
+            toggleGenreFilter(value);
+        }
+    });
+    connect(executor, &QueryExecutor::cubeReady, this, [this](const SalesCubePtr &loaded) {
+        cube = loaded;
+        if (!filter.isEmpty() && currentView) {
+            currentView();
+        }
+    });
+
+    // Продажи по периодам: гранулярность и диапазон дат отвечаются
+    // временным кубом без повторного чтения invoices
+    granularityBox = new QComboBox(this);
+    const QPair<QString, TimeGranularity> granularities[] = {
+        {"День", TimeGranularity::Day},
+        {"Неделя", TimeGranularity::Week},
+        {"Месяц", TimeGranularity::Month},
+        {"Квартал", TimeGranularity::Quarter}
+    };
+    for (const auto &granularity : granularities) {
+        granularityBox->addItem(granularity.first, int(granularity.second));
+    }
+    granularityBox->setCurrentIndex(granularityBox->findData(int(TimeGranularity::Month)));
+    rangeFromSlider = new QSlider(Qt::Horizontal, this);
+    rangeToSlider = new QSlider(Qt::Horizontal, this);
+    rangeFromSlider->setEnabled(false);
+    rangeToSlider->setEnabled(false);
+    rangeLabel = new QLabel(this);
+    ui->mainToolBar->addSeparator();
+    ui->mainToolBar->addWidget(granularityBox);
+    ui->mainToolBar->addWidget(rangeFromSlider);
+    ui->mainToolBar->addWidget(rangeToSlider);
+    ui->mainToolBar->addWidget(rangeLabel);
+
+    // Пока открыты продажи по месяцам, смена гранулярности или диапазона
+    // заново выбирает, чем их считать (см. showMonthlySales)
+    connect(granularityBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        if (timeSalesShown) {
+            showMonthlySales();
+        }
+    });
+    // Начало не может быть позже конца: второй ползунок сдвигается следом
+    connect(rangeFromSlider, &QSlider::valueChanged, this, [this](int value) {
+        if (rangeToSlider->value() < value) {
+            QSignalBlocker blocker(rangeToSlider);
+            rangeToSlider->setValue(value);
+        }
+        updateRangeLabel();
+        if (timeSalesShown) {
+            showMonthlySales();
+        }
+    });
+    connect(rangeToSlider, &QSlider::valueChanged, this, [this](int value) {
+        if (rangeFromSlider->value() > value) {
+            QSignalBlocker blocker(rangeFromSlider);
+            rangeFromSlider->setValue(value);
+        }
+        updateRangeLabel();
+        if (timeSalesShown) {
+            showMonthlySales();
+        }
+    });
+    connect(executor, &QueryExecutor::timeCubeReady, this, [this](const TimeCubePtr &loaded) {
+        // При перезагрузке после изменения данных выбранные даты
+        // сохраняются; диапазон, доходивший до конца, растёт вместе с данными
+        QDate from;
+        QDate to;
+        bool toEnd = true;
+        if (timeCube) {
+            from = timeCube->firstDay().addDays(rangeFromSlider->value());
+            to = timeCube->firstDay().addDays(rangeToSlider->value());
+            toEnd = rangeToSlider->value() == rangeToSlider->maximum();
+        }
+        timeCube = loaded;
+        QDate first = timeCube->firstDay();
+        int days = int(first.daysTo(timeCube->lastDay()));
+        for (QSlider *slider : {rangeFromSlider, rangeToSlider}) {
+            QSignalBlocker blocker(slider);
+            slider->setRange(0, days);
+            slider->setEnabled(true);
+        }
+        {
+            QSignalBlocker fromBlocker(rangeFromSlider);
+            QSignalBlocker toBlocker(rangeToSlider);
+            rangeFromSlider->setValue(from.isValid() ? int(first.daysTo(from)) : 0);
+            rangeToSlider->setValue(toEnd ? days : int(first.daysTo(to)));
+        }
+        updateRangeLabel();
+        if (timeSalesShown && timeFilterActive()) {
+            displayTimeSales();
+        }
+    });
+    executor->loadCube();
 
+    // Подключаем кнопки к слотам: каждая кнопка запускает один отчёт
+    connect(ui->btnMonthlySales, &QPushButton::clicked, this, &MainWindow::showMonthlySales);
     connect(ui->btnRevenueByGenre, &QPushButton::clicked, this, &MainWindow::showRevenueByGenre);
-    connect(ui->btnRevenueByGenre, &QPushButton::clicked, this, &MainWindow::showRevenueByGenreChart);
-
     connect(ui->btnTop3Artists, &QPushButton::clicked, this, &MainWindow::showTop3ArtistsByGenre);
-    connect(ui->btnTop3Artists, &QPushButton::clicked, this, &MainWindow::showTop3ArtistsByGenreChart);
-
     connect(ui->btnTop5Artists, &QPushButton::clicked, this, &MainWindow::showTop5ArtistsOverall);
-    connect(ui->btnTop5Artists, &QPushButton::clicked, this, &MainWindow::showTop5ArtistsPentagonChart);
-    connect(ui->btnTop5Artists, &QPushButton::clicked, this, &MainWindow::showTop5ArtistsChart);
-
     connect(ui->btnInteractiveMapSum, &QPushButton::clicked, this, &MainWindow::showInteractiveMapSum);
-    connect(ui->btnInteractiveMapSum, &QPushButton::clicked, this, &MainWindow::showInteractiveMapSumChart);
-
     connect(ui->btnInteractiveMapGenre, &QPushButton::clicked, this, &MainWindow::showInteractiveMapGenre);
 }
 
 MainWindow::~MainWindow()
 {
     delete ui;
-    db.close();
 }
 
-void MainWindow::clearScene()
+void MainWindow::runReport(ReportId id, const QueryExecutor::Handler &handler, int topPerGroup)
 {
-    if (ui->graphicsView->scene()) {
-        ui->graphicsView->scene()->clear();
-        ui->graphicsView->viewport()->update();
-    }
-    if (ui->chartView->scene()) {
-        ui->chartView->scene()->clear();
-        ui->chartView->viewport()->update();
+    currentView = [this, id, handler, topPerGroup]() { runReport(id, handler, topPerGroup); };
+    timeSalesShown = false;
+
+    // С трассировкой после показа отчёта строка состояния показывает
+    // время по фазам от запроса до отрисовки
+    qint64 traceStart = Tracing::now();
+    QueryExecutor::Handler traced = [this, handler, traceStart](const QueryResult &result) {
+        {
+            TRACE_SCOPE_CATEGORY("handler", "gui");
+            handler(result);
+        }
+        if (Tracing::isEnabled()) {
+            ui->statusBar->showMessage(Tracing::summary(traceStart), 10000);
+        }
+    };
+
+    // С фильтром отчёт считается по срезам куба прямо в GUI-потоке
+    if (!filter.isEmpty()) {
+        executor->cancel("report");
+        if (!cube) {
+            ui->statusBar->showMessage("Куб продаж загружается, фильтр будет применён после загрузки");
+            return;
+        }
+        // Если данные изменились, рабочий поток перезагрузит куб, и отчёт
+        // пересчитается по новому кубу при его получении
+        executor->checkCube();
+        QElapsedTimer timer;
+        timer.start();
+        traced(cube->run(id, filter));
+        if (!Tracing::isEnabled()) {
+            ui->statusBar->showMessage(QString("Фильтр применён за %1 мс").arg(timer.elapsed()), 3000);
+        }
+        return;
     }
+
+    // Один запрос на отчёт; более новый отчёт отменяет незавершённый
+    const ReportDefinition &report = Reports::definition(id);
+    QueryRequest request;
+    request.report = report.name;
+    request.sql = report.sql;
+    request.rollupSql = report.rollupSql;
+    request.topPerGroup = topPerGroup;
+    executor->submit("report", request, traced);
 }
 
+void MainWindow::toggleCountryFilter(const QString &country)
+{
+    // Повторный щелчок по выбранному значению снимает фильтр
+    filter.country = filter.country == country ? QString() : country;
+    applyFilter();
+}
+
+void MainWindow::toggleGenreFilter(const QString &genre)
+{
+    filter.genre = filter.genre == genre ? QString() : genre;
+    applyFilter();
+}
 
-void MainWindow::displayTable(QSqlQuery query, const QStringList &headers)
+void MainWindow::applyFilter()
 {
+    QStringList parts;
+    if (!filter.country.isEmpty()) {
+        parts << "страна: " + filter.country;
+    }
+    if (!filter.genre.isEmpty()) {
+        parts << "жанр: " + filter.genre;
+    }
+    filterLabel->setText(parts.isEmpty() ? QString() : "Фильтр — " + parts.join(", "));
 
-    QStandardItemModel *model = new QStandardItemModel(this);
-    int columnCount = headers.size();
-    model->setColumnCount(columnCount);
+    // Текущий отчёт пересчитывается с новым фильтром
+    if (currentView) {
+        currentView();
+    }
+}
 
-    // Устанавливаем заголовки
-    for (int i = 0; i < columnCount; ++i) {
-        model->setHeaderData(i, Qt::Horizontal, headers[i]);
+void MainWindow::updateRangeLabel()
+{
+    if (!timeCube) {
+        return;
     }
+    QDate first = timeCube->firstDay();
+    rangeLabel->setText(QString("%1 — %2")
+                            .arg(first.addDays(rangeFromSlider->value()).toString("yyyy-MM-dd"))
+                            .arg(first.addDays(rangeToSlider->value()).toString("yyyy-MM-dd")));
+}
 
-    // Заполняем модель данными
-    int row = 0;
-    while (query.next()) {
-        for (int col = 0; col < columnCount; ++col) {
-            model->setItem(row, col, new QStandardItem(query.value(col).toString()));
-        }
-        ++row;
+void MainWindow::clearScene()
+{
+    // Сцена карты не очищается: её элементы живут всё время работы
+    if (ui->graphicsView->scene() == mapScene) {
+        mapScene->hideMarkers();
+    } else if (ui->graphicsView->scene()) {
+        ui->graphicsView->scene()->clear();
+        ui->graphicsView->viewport()->update();
     }
+    // Диаграмма заменяется пустой: очистка сцены удалила бы QChart под видом
+    chartUpdater->clear();
+}
 
-    ui->tableView->setModel(model);
+
+void MainWindow::displayTable(const QueryResult &result, const QStringList &headers)
+{
+    TRACE_SCOPE("displayTable");
+    // Одна модель на всё время работы: ячейки форматируются лениво,
+    // строки подгружаются порциями при прокрутке
+    tableModel->setResult(result, headers);
+    if (ui->tableView->model() != tableModel) {
+        ui->tableView->setModel(tableModel);
+    }
+    TRACE_SCOPE("resizeColumnsToContents");
     ui->tableView->resizeColumnsToContents();
 }
 
+bool MainWindow::timeFilterActive() const
+{
+    if (!timeCube) {
+        return false;
+    }
+    bool monthly = TimeGranularity(granularityBox->currentData().toInt()) == TimeGranularity::Month;
+    bool wholeRange = rangeFromSlider->value() == rangeFromSlider->minimum()
+                      && rangeToSlider->value() == rangeToSlider->maximum();
+    return !monthly || !wholeRange;
+}
+
 void MainWindow::showMonthlySales()
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT strftime('%Y-%m', invoices.InvoiceDate) AS Month, SUM(invoice_items.Quantity) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        GROUP BY Month
-        ORDER BY Month;
-    )");
-    displayTable(query, {"Data", "Total sales"});
+    TRACE_SCOPE("showMonthlySales");
+    // Другую гранулярность или диапазон дат считает только временной куб.
+    // Обычные продажи по месяцам идут через выбранный движок, чтобы SQL,
+    // агрегаты, колоночный и параллельный пути можно было сравнить
+    if (timeFilterActive()) {
+        executor->cancel("report");
+        executor->checkCube();
+        currentView = [this]() { showMonthlySales(); };
+        timeSalesShown = true;
+        displayTimeSales();
+        return;
+    }
+    runReport(ReportId::MonthlySales, [this](const QueryResult &result) {
+        displayTable(result, {"Data", "Total sales"});
+        displayMonthlySalesChart(Reports::monthlySales(result));
+    });
+    currentView = [this]() { showMonthlySales(); };
+    timeSalesShown = true;
 }
 
-void MainWindow::showMonthlySalesChart()
+void MainWindow::displayMonthlySalesChart(const QVector<MonthlySales> &rows)
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT strftime('%Y', invoices.InvoiceDate) AS Year,
-               strftime('%m', invoices.InvoiceDate) AS Month,
-               SUM(invoice_items.Quantity) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        GROUP BY Year, Month
-        ORDER BY Year, Month;
-    )");
-
-    QBarSeries *series = new QBarSeries();
-    QMap<QString, QBarSet*> yearSets; // QBarSet для каждого года
+    TRACE_SCOPE("displayMonthlySalesChart");
+    // Ось X: месяцы от 1 до 12
     QStringList months;
-
-    // Инициализация месяцев (от 1 до 12)
     for (int i = 1; i <= 12; ++i) {
         months << QString::number(i);
     }
 
-    // Добавляем значения в QBarSet для каждого года
-    while (query.next()) {
-        QString year = query.value("Year").toString();
-        int month = query.value("Month").toInt();
-        double sales = query.value("TotalSales").toDouble();
-
-        // Создаём QBarSet для года, если его ещё нет
-        if (!yearSets.contains(year)) {
-            yearSets[year] = new QBarSet(year);
+    // Набор столбцов для каждого года, незаполненные месяцы — нули
+    QVector<ChartUpdater::BarSetData> yearSets;
+    QMap<int, int> yearIndex; // год -> номер набора
+    for (const MonthlySales &row : rows) {
+        auto it = yearIndex.constFind(row.year);
+        if (it == yearIndex.constEnd()) {
+            it = yearIndex.insert(row.year, yearSets.size());
+            QList<qreal> zeros;
             for (int i = 0; i < 12; ++i) {
-                yearSets[year]->append(0); // Заполняем нулями все месяцы
+                zeros << 0;
             }
-            series->append(yearSets[year]);
+            yearSets.append({QString::number(row.year), zeros});
         }
+        yearSets[it.value()].values[row.monthOfYear - 1] = row.quantity;
+    }
+
+    // Диаграмма и оси переиспользуются, данные заменяются целиком
+    chartUpdater->showBars("Monthly Sales by Year", months, yearSets, false, "Month", "Total Sales");
+}
 
-        // Добавляем продажи в соответствующий месяц
-        yearSets[year]->replace(month-1, sales);
+void MainWindow::displayTimeSales()
+{
+    qint64 traceStart = Tracing::now();
+    TRACE_SCOPE("displayTimeSales");
+    QElapsedTimer timer;
+    timer.start();
+
+    TimeGranularity granularity = TimeGranularity(granularityBox->currentData().toInt());
+    QDate first = timeCube->firstDay();
+    QVector<PeriodSales> periods = timeCube->run(granularity, first.addDays(rangeFromSlider->value()),
+                                                 first.addDays(rangeToSlider->value()), filter);
+
+    QueryResult table;
+    table.columns << "Period" << "TotalSales";
+    for (const PeriodSales &period : periods) {
+        table.appendRow({period.label, period.quantity});
     }
+    displayTable(table, {"Period", "Total sales"});
 
-    // Настраиваем график
-    QChart *chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle("Monthly Sales by Year");
-    chart->setAnimationOptions(QChart::SeriesAnimations);
-
-    // Ось X: месяца от 1 до 12
-    QBarCategoryAxis *axisX = new QBarCategoryAxis();
-    axisX->append(months);
-    axisX->setTitleText("Month");
-    chart->addAxis(axisX, Qt::AlignBottom);
-    series->attachAxis(axisX);
-
-    // Ось Y: продажи
-    QValueAxis *axisY = new QValueAxis();
-    axisY->setTitleText("Total Sales");
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
-
-    // Легенда с годами
-    chart->legend()->setVisible(true);
-    chart->legend()->setAlignment(Qt::AlignBottom);
+    // Помесячно остаётся прежняя диаграмма по годам
+    if (granularity == TimeGranularity::Month) {
+        QVector<MonthlySales> rows;
+        for (const PeriodSales &period : periods) {
+            rows.append({period.label, period.start.year(), period.start.month(), double(period.quantity)});
+        }
+        displayMonthlySalesChart(rows);
+    } else {
+        displayPeriodSalesChart(periods, granularity);
+    }
 
-    // Устанавливаем график на chartView
-    ui->chartView->setChart(chart);
-    ui->chartView->setRenderHint(QPainter::Antialiasing);
+    if (Tracing::isEnabled()) {
+        ui->statusBar->showMessage(Tracing::summary(traceStart), 10000);
+    } else {
+        ui->statusBar->showMessage(QString("Продажи по периодам: %1 мс").arg(timer.elapsed()), 3000);
+    }
 }
 
-void MainWindow::showRevenueByGenre()
+void MainWindow::displayPeriodSalesChart(const QVector<PeriodSales> &periods, TimeGranularity granularity)
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT genres.Name AS GenreName, ROUND(SUM(invoice_items.Quantity * invoice_items.UnitPrice), 2) AS Revenue
-        FROM invoice_items
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY genres.GenreId
-        ORDER BY Revenue DESC;
-    )");
-    displayTable(query, {"Genre", "Revenue"});
+    TRACE_SCOPE("displayPeriodSalesChart");
+    // Ось X: даты начала периодов
+    QVector<QPointF> points;
+    points.reserve(periods.size());
+    for (const PeriodSales &period : periods) {
+        points.append(QPointF(QDateTime(period.start).toMSecsSinceEpoch(), period.quantity));
+    }
+    chartUpdater->showLine("Sales by Period", points, true,
+                           granularity == TimeGranularity::Quarter ? "yyyy-MM" : "yyyy-MM-dd",
+                           "Period", "Total Sales");
 }
 
-void MainWindow::showRevenueByGenreChart()
+void MainWindow::showRevenueByGenre()
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT genres.Name AS GenreName, ROUND(SUM(invoice_items.Quantity * invoice_items.UnitPrice), 2) AS Revenue
-        FROM invoice_items
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY genres.GenreId
-        ORDER BY Revenue DESC;
-    )");
+    TRACE_SCOPE("showRevenueByGenre");
+    runReport(ReportId::RevenueByGenre, [this](const QueryResult &result) {
+        displayTable(result, {"Genre", "Revenue"});
+        displayRevenueByGenreChart(Reports::revenueByGenre(result));
+    });
+}
 
+void MainWindow::displayRevenueByGenreChart(const QVector<GenreRevenue> &rows)
+{
+    TRACE_SCOPE("displayRevenueByGenreChart");
     // Создаём круговую диаграмму
     QPieSeries *series = new QPieSeries();
 
     double otherRevenue = 0.0; // Для суммирования мелких сегментов
     int count = 0;             // Счётчик сегментов
 
-    while (query.next()) {
-        QString genreName = query.value("GenreName").toString();
-        double revenue = query.value("Revenue").toDouble();
+    for (const GenreRevenue &row : rows) {
+        QString genreName = row.genre;
+        double revenue = row.revenue;
 
         if (count < 10) { // Добавляем первые 10 сегментов
-            series->append(genreName, revenue);
+            // Щелчок по сегменту фильтрует остальные представления по жанру
+            QPieSlice *slice = series->append(genreName, revenue);
+            slice->setExploded(genreName == filter.genre);
+            connect(slice, &QPieSlice::clicked, this, [this, genreName]() {
+                toggleGenreFilter(genreName);
+            });
         } else { // Остальные добавляем в категорию "Other"
             otherRevenue += revenue;
         }
@@ -297,180 +575,116 @@ void MainWindow::showRevenueByGenreChart()
     // Выделяем сегменты и отображаем метки только для топ-10
     for (auto slice : series->slices()) {
             slice->setLabel(QString("%1: %2").arg(slice->label()).arg(slice->value()));
-            slice->setExploded(false);
             slice->setLabelVisible(true);
     }
 
     // Отображаем диаграмму
-    ui->chartView->setChart(chart);
-    ui->chartView->setRenderHint(QPainter::Antialiasing);
+    chartUpdater->setChart(chart);
 }
 
 
 void MainWindow::showTop3ArtistsByGenre()
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT GenreName, ArtistName, TotalSales
-        FROM (
-            SELECT genres.Name AS GenreName, artists.Name AS ArtistName,
-                   SUM(invoice_items.Quantity) AS TotalSales,
-                   RANK() OVER (PARTITION BY genres.GenreId ORDER BY SUM(invoice_items.Quantity) DESC) AS Rank
-            FROM invoice_items
-            JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-            JOIN albums ON tracks.AlbumId = albums.AlbumId
-            JOIN artists ON albums.ArtistId = artists.ArtistId
-            JOIN genres ON tracks.GenreId = genres.GenreId
-            GROUP BY genres.GenreId, artists.ArtistId
-        )
-        WHERE Rank <= 3
-        ORDER BY GenreName, Rank;
-    )");
-    displayTable(query, {"Genre", "Artist", "Total Sales"});
+    TRACE_SCOPE("showTop3ArtistsByGenre");
+    runReport(ReportId::ArtistsByGenre, [this](const QueryResult &result) {
+        QVector<ArtistGenreSales> rows = Reports::artistsByGenre(result);
+        displayTable(Reports::topArtistsByGenreTable(rows, 3), {"Genre", "Artist", "Total Sales"});
+        displayTop3ArtistsByGenreChart(rows);
+
+        // Приближённый топ сообщает, насколько продажи могут быть завышены
+        int errorColumn = result.columnIndex("MaxError");
+        if (errorColumn >= 0) {
+            qint64 maxError = 0;
+            for (int row = 0; row < result.rowCount(); ++row) {
+                maxError = qMax(maxError, result.value(row, errorColumn).toLongLong());
+            }
+            ui->statusBar->showMessage(QString("Топ по скетчам: продажи завышены не больше чем на %1").arg(maxError), 5000);
+        }
+    }, 3);
 }
 
 
-void MainWindow::showTop3ArtistsByGenreChart()
+void MainWindow::displayTop3ArtistsByGenreChart(const QVector<ArtistGenreSales> &rows)
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT genres.Name AS GenreName, artists.Name AS ArtistName, SUM(invoice_items.Quantity) AS TotalSales
-        FROM invoice_items
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN albums ON tracks.AlbumId = albums.AlbumId
-        JOIN artists ON albums.ArtistId = artists.ArtistId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY genres.Name, artists.Name
-        ORDER BY genres.Name, TotalSales DESC;
-    )");
-
+    TRACE_SCOPE("displayTop3ArtistsByGenreChart");
     // Сопоставление жанров с их топ-3 артистами
     QMap<QString, QVector<QPair<QString, int>>> genreData;
 
-    while (query.next()) {
-        QString genre = query.value("GenreName").toString();
-        QString artist = query.value("ArtistName").toString();
-        int sales = query.value("TotalSales").toInt();
-
-        if (!genreData.contains(genre)) {
-            genreData[genre] = QVector<QPair<QString, int>>();
-        }
-
+    for (const ArtistGenreSales &row : rows) {
         // Добавляем только топ-3 артистов для каждого жанра
-        if (genreData[genre].size() < 3) {
-            genreData[genre].append(qMakePair(artist, sales));
+        QVector<QPair<QString, int>> &topArtists = genreData[row.genre];
+        if (topArtists.size() < 3) {
+            topArtists.append(qMakePair(row.artist, row.sales));
         }
     }
 
-    // Создаём серию для stacked bar chart
-    QStackedBarSeries *series = new QStackedBarSeries();
+    // Наборы "Top 1".."Top 3", в каждом значение на жанр
     QStringList categories; // Список жанров для оси X
-
-    // Добавляем данные для каждого жанра
-    for (auto it = genreData.begin(); it != genreData.end(); ++it) {
-        QString genre = it.key();
-        categories << genre;
-
-        QVector<QPair<QString, int>> topArtists = it.value();
-
+    QVector<ChartUpdater::BarSetData> sets;
+    for (int i = 0; i < 3; ++i) {
+        sets.append({QString("Top %1").arg(i + 1), QList<qreal>()});
+    }
+    for (auto it = genreData.constBegin(); it != genreData.constEnd(); ++it) {
+        categories << it.key();
+        const QVector<QPair<QString, int>> &topArtists = it.value();
         for (int i = 0; i < 3; ++i) {
-            QString artistName = (i < topArtists.size()) ? topArtists[i].first : "N/A";
-            int sales = (i < topArtists.size()) ? topArtists[i].second : 0;
-
-            // Добавляем сегменты для каждого артиста
-            QBarSet *set = nullptr;
-            if (series->count() <= i) {
-                set = new QBarSet(QString("Top %1").arg(i + 1));
-                series->append(set);
-            } else {
-                set = series->barSets().at(i);
-            }
-            *set << sales;
+            sets[i].values << ((i < topArtists.size()) ? topArtists[i].second : 0);
         }
     }
 
-    // Настройка графика
-    QChart *chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle("Top 3 Artists by Genre");
-    chart->setAnimationOptions(QChart::SeriesAnimations);
-
-    // Ось X: названия жанров
-    QBarCategoryAxis *axisX = new QBarCategoryAxis();
-    axisX->append(categories);
-    axisX->setTitleText("Genres");
-    axisX->setLabelsAngle(-90); // Поворачиваем текст на 90 градусов (вертикально)
-    chart->addAxis(axisX, Qt::AlignBottom);
-    series->attachAxis(axisX);
-
-
-    // Ось Y: количество продаж
-    QValueAxis *axisY = new QValueAxis();
-    axisY->setTitleText("Total Sales");
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
-
-    // Легенда
-    chart->legend()->setVisible(true);
-    chart->legend()->setAlignment(Qt::AlignBottom);
-
-    // Отображаем диаграмму
-    ui->chartView->setChart(chart);
-    ui->chartView->setRenderHint(QPainter::Antialiasing);
+    // Жанры подписаны вертикально
+    chartUpdater->showBars("Top 3 Artists by Genre", categories, sets, true, "Genres", "Total Sales", -90);
 }
 
 
 void MainWindow::showTop5ArtistsOverall()
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT artists.Name AS ArtistName, SUM(invoice_items.Quantity) AS TotalQuantity, ROUND(SUM(invoice_items.UnitPrice * invoice_items.Quantity), 2) AS TotalSales
-        FROM invoice_items
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN albums ON tracks.AlbumId = albums.AlbumId
-        JOIN artists ON albums.ArtistId = artists.ArtistId
-        GROUP BY artists.ArtistId
-        ORDER BY TotalSales DESC
-        LIMIT 5;
-    )");
-    displayTable(query, {"Artist", "Total Quantity", "Total Sales"});
+    TRACE_SCOPE("showTop5ArtistsOverall");
+    runReport(ReportId::TopArtists, [this](const QueryResult &result) {
+        QVector<ArtistRevenue> rows = Reports::topArtists(result);
+        displayTable(result, {"Artist", "Total Quantity", "Total Sales"});
+        displayTop5ArtistsPentagonChart(rows);
+        displayTop5ArtistsChart(rows);
+    });
 }
 
 
-void MainWindow::showTop5ArtistsPentagonChart()
+void MainWindow::displayTop5ArtistsPentagonChart(const QVector<ArtistRevenue> &rows)
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT artists.Name AS ArtistName, ROUND(SUM(invoice_items.UnitPrice * invoice_items.Quantity), 2) AS Revenue
-        FROM invoice_items
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN albums ON tracks.AlbumId = albums.AlbumId
-        JOIN artists ON albums.ArtistId = artists.ArtistId
-        GROUP BY artists.ArtistId
-        ORDER BY Revenue DESC
-        LIMIT 5;
-    )");
-
+    TRACE_SCOPE("displayTop5ArtistsPentagonChart");
     QVector<QPair<QString, double>> artistData;
     double totalRevenue = 0;
 
-    while (query.next()) {
-        QString artistName = query.value("ArtistName").toString();
-        double revenue = query.value("Revenue").toDouble();
+    for (const ArtistRevenue &row : rows) {
+        if (artistData.size() == 5) {
+            break;
+        }
+        QString artistName = row.artist;
+        double revenue = row.revenue;
         artistData.append(qMakePair(artistName, revenue));
         totalRevenue += revenue; // Суммируем для среднего значения
     }
 
-    double averageRevenue = totalRevenue / artistData.size(); // Среднее значение
+    QGraphicsScene *scene = shapeScene;
+    scene->clear();
+    ui->graphicsView->setScene(scene);
+    ui->graphicsView->setMapRendering(false);
+    // В жанре с перекрёстным фильтром артистов может быть меньше пяти или
+    // не быть вовсе; без продаж рисовать нечего
+    if (artistData.isEmpty() || artistData[0].second <= 0) {
+        ui->graphicsView->show();
+        return;
+    }
 
-    QGraphicsScene *scene = new QGraphicsScene(this);
+    double averageRevenue = totalRevenue / artistData.size(); // Среднее значение
     QPointF center(300, 300);
     double radius = 300;
 
     QVector<QPointF> maxPoints, avgPoints;
 
-    // Создаём точки для максимального и среднего пятиугольника
-    for (int i = 0; i < 5; ++i) {
+    // Создаём точки для максимального и среднего пятиугольника; вершины
+    // остаются на своих местах, недостающие артисты просто не рисуются
+    for (int i = 0; i < artistData.size(); ++i) {
         double angle = 2 * M_PI * i / 5 - M_PI / 2;
 
         // Точки для максимального значения (нормализуем по максимальному значению)
@@ -491,7 +705,7 @@ void MainWindow::showTop5ArtistsPentagonChart()
     scene->addPolygon(avgPentagon, QPen(Qt::blue, 2), QBrush(QColor(0, 255, 255, 50))); // Яркая голубая заливка
 
     // Добавляем подписи для вершин
-    for (int i = 0; i < 5; ++i) {
+    for (int i = 0; i < artistData.size(); ++i) {
         QGraphicsTextItem *label = scene->addText(QString("%1\n%2").arg(artistData[i].first).arg(artistData[i].second));
         label->setPos(maxPoints[i] + QPointF(-40, -40)); // Подписи на внешних вершинах
     }
@@ -500,30 +714,18 @@ void MainWindow::showTop5ArtistsPentagonChart()
     avgLabel->setPos(avgPoints[0] + QPointF(-30, -30)); // Размещаем подпись на первой вершине среднего пятиугольника
 
     // Отображаем сцену
-    ui->graphicsView->setScene(scene);
     ui->graphicsView->show();
 }
 
-void MainWindow::showTop5ArtistsChart()
+void MainWindow::displayTop5ArtistsChart(const QVector<ArtistRevenue> &rows)
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT artists.Name AS ArtistName, ROUND(SUM(invoice_items.UnitPrice * invoice_items.Quantity), 2) AS Revenue
-        FROM invoice_items
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN albums ON tracks.AlbumId = albums.AlbumId
-        JOIN artists ON albums.ArtistId = artists.ArtistId
-        GROUP BY artists.ArtistId
-        ORDER BY Revenue DESC
-        LIMIT 5;
-    )");
-
+    TRACE_SCOPE("displayTop5ArtistsChart");
     // Создаём круговую диаграмму
     QPieSeries *series = new QPieSeries();
 
-    while (query.next()) {
-        QString artistName = query.value("ArtistName").toString();
-        double revenue = query.value("Revenue").toDouble();
+    for (const ArtistRevenue &row : rows) {
+        QString artistName = row.artist;
+        double revenue = row.revenue;
 
         series->append(artistName, revenue);
     }
@@ -541,8 +743,7 @@ void MainWindow::showTop5ArtistsChart()
     chart->legend()->setAlignment(Qt::AlignBottom);
 
     // Отображаем диаграмму
-    ui->chartView->setChart(chart);
-    ui->chartView->setRenderHint(QPainter::Antialiasing);
+    chartUpdater->setChart(chart);
 }
 
 QMap<QString, QColor> MainWindow::GenerateGenreColors(const QMap<QString, QMap<QString, double>> &mapData)
@@ -564,66 +765,34 @@ QMap<QString, QColor> MainWindow::GenerateGenreColors(const QMap<QString, QMap<Q
 
 void MainWindow::showInteractiveMapSum()
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT BillingCountry, ROUND(SUM(invoice_items.Quantity * invoice_items.UnitPrice), 2) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY BillingCountry
-        ORDER BY TotalSales DESC;
-    )");
-
-    QMap<QString, QMap<QString, double>> mapData; // Map<Country, Map<Genre, Sales>>
-    displayTable(query, {"Country", "Total sales"});
-    query.exec(R"(
-        SELECT BillingCountry, genres.Name AS GenreName, SUM(invoice_items.Quantity) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY BillingCountry, genres.GenreId
-        ORDER BY BillingCountry, TotalSales DESC;
-    )");
-
-    while (query.next()) {
-        QString country = query.value("BillingCountry").toString();
-        QString genre = query.value("GenreName").toString();
-        double sales = query.value("TotalSales").toDouble();
-
-        mapData[country][genre] += sales;
-    }
-
-    displayMapSum(mapData); // Передаём данные для отображения
+    TRACE_SCOPE("showInteractiveMapSum");
+    runReport(ReportId::SalesByCity, [this](const QueryResult &result) {
+        QVector<CitySales> rows = Reports::salesByCity(result);
+        QVector<CountryRevenue> countries = Reports::countryTotals(rows);
+
+        displayTable(Reports::countryTotalsTable(countries), {"Country", "Total sales"});
+        displayMapSum(rows); // Передаём данные для отображения
+        displayInteractiveMapSumChart(countries);
+    });
 }
 
-void MainWindow::showInteractiveMapSumChart()
+void MainWindow::displayInteractiveMapSumChart(const QVector<CountryRevenue> &rows)
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT BillingCountry, ROUND(SUM(invoice_items.Quantity * invoice_items.UnitPrice), 2) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY BillingCountry
-        ORDER BY TotalSales DESC;
-    )");
-
-    QMap<QString, QMap<QString, double>> mapData; // Map<Country, Map<Genre, Sales>>
-    QMap<QString, int> countryData;
+    TRACE_SCOPE("displayInteractiveMapSumChart");
     QPieSeries *series = new QPieSeries();
 
     double otherSales = 0.0; // Для суммирования мелких сегментов
     int count = 0;             // Счётчик сегментов
 
-    while (query.next()) {
-        QString countryName = query.value("BillingCountry").toString();
-        QString artist = query.value("ArtistName").toString();
-        int sales = query.value("TotalSales").toInt();
+    for (const CountryRevenue &row : rows) {
+        QString countryName = row.country;
+        int sales = qRound(row.revenue);
         if (count < 10) { // Добавляем первые 10 сегментов
-            series->append(countryName, sales);
+            QPieSlice *slice = series->append(countryName, sales);
+            slice->setExploded(countryName == filter.country);
+            connect(slice, &QPieSlice::clicked, this, [this, countryName]() {
+                toggleCountryFilter(countryName);
+            });
         } else { // Остальные добавляем в категорию "Other"
             otherSales += sales;
         }
@@ -639,100 +808,45 @@ void MainWindow::showInteractiveMapSumChart()
 
     for (auto slice : series->slices()) {
             slice->setLabel(QString("%1: %2").arg(slice->label()).arg(slice->value()));
-            slice->setExploded(false);
             slice->setLabelVisible(true);
     }
 
     // Отображаем диаграмму
-    ui->chartView->setChart(chart);
-    ui->chartView->setRenderHint(QPainter::Antialiasing);
+    chartUpdater->setChart(chart);
 }
 
 void MainWindow::showInteractiveMapGenre()
 {
-    QSqlQuery query(db);
-    query.exec(R"(
-        SELECT BillingCountry, ROUND(SUM(invoice_items.Quantity * invoice_items.UnitPrice), 2) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY BillingCountry
-        ORDER BY TotalSales DESC;
-    )");
-
-    QMap<QString, QMap<QString, double>> mapData; // Map<Country, Map<Genre, Sales>>
-    displayTable(query, {"Country", "Total sales"});
-    query.exec(R"(
-        SELECT BillingCountry, genres.Name AS GenreName, SUM(invoice_items.Quantity) AS TotalSales
-        FROM invoice_items
-        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
-        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
-        JOIN genres ON tracks.GenreId = genres.GenreId
-        GROUP BY BillingCountry, genres.GenreId
-        ORDER BY BillingCountry, TotalSales DESC;
-    )");
-
-    while (query.next()) {
-        QString country = query.value("BillingCountry").toString();
-        QString genre = query.value("GenreName").toString();
-        double sales = query.value("TotalSales").toDouble();
-
-        mapData[country][genre] += sales;
-    }
-
-    displayMapGenre(mapData); // Передаём данные для отображения
+    TRACE_SCOPE("showInteractiveMapGenre");
+    runReport(ReportId::SalesByCountryGenre, [this](const QueryResult &result) {
+        QVector<CountryGenreSales> rows = Reports::salesByCountryGenre(result);
+        displayMapGenre(Reports::countryGenreQuantities(rows)); // Передаём данные для отображения
+    });
 }
 
 
-void MainWindow::AddLegendToScene(QGraphicsScene *scene, const QMap<QString, QColor> &genreColors)
-{
-    double x = 900; // Координаты начала легенды
-    double y = 50;
-
-    for (auto it = genreColors.begin(); it != genreColors.end(); ++it) {
-        QString genre = it.key();
-        QColor color = it.value();
-
-        // Рисуем цветной квадрат
-        scene->addRect(x, y, 20, 20, QPen(Qt::NoPen), QBrush(color));
-
-        // Добавляем текст жанра
-        QGraphicsTextItem *label = scene->addText(genre);
-        label->setPos(x + 30, y);
-
-        y += 15; // Смещение вниз для следующего жанра
-    }
-}
-
 void MainWindow::displayMapGenre(const QMap<QString, QMap<QString, double>> &mapData)
 {
+    TRACE_SCOPE("displayMapGenre");
     // Генерация цветов для жанров
     QMap<QString, QColor> genreColors = GenerateGenreColors(mapData);
 
-    // Создаём сцену для карты
-    QGraphicsScene *scene = new QGraphicsScene(this);
-    ui->graphicsView->setScene(scene);
-
-    // Устанавливаем фон карты
-    QPixmap mapPixmap("C:\\Qt\\Qt5.12.2\\Projects\\SalesAnalytics\\world_map.png");
-    QGraphicsPixmapItem *mapItem = scene->addPixmap(mapPixmap);
-    mapItem->setZValue(-1);
+    // Та же сцена карты, маркеры обновляются на месте
+    ui->graphicsView->setScene(mapScene);
+    ui->graphicsView->setMapRendering(true);
+    mapScene->beginUpdate();
 
-    QStandardItemModel *model = new QStandardItemModel(this);
-    model->setHorizontalHeaderLabels({"Country", "Top Genre", "Sales"});
+    QueryResult table;
+    table.columns << "Country" << "TopGenre" << "Sales";
 
     // Добавление данных в карту и таблицу
-    int row = 0;
     for (const auto &country : mapData.keys()) {
-        if (!countryCoordinates.contains(country)) {
-            qDebug() << "Missing coordinates for country:" << country;
+        // Координаты на карте
+        QPointF coords;
+        if (!mapScene->countryPosition(country, &coords)) {
             continue;
         }
 
-        // Координаты на карте
-        QPointF coords = countryCoordinates[country];
-
         // Топовый жанр и продажи
         QString topGenre;
         double topSales = 0.0;
@@ -746,22 +860,18 @@ void MainWindow::displayMapGenre(const QMap<QString, QMap<QString, double>> &map
         // Рисуем круг для страны на карте
         QColor genreColor = genreColors.value(topGenre, QColor(Qt::black));
         double radius = sqrt(topSales)*3;
-        scene->addEllipse(
-            coords.x() - radius / 2, coords.y() - radius / 2, radius, radius,
-            QPen(Qt::NoPen), QBrush(genreColor, Qt::SolidPattern)
-        );
+        mapScene->setMarker(country, coords, radius, genreColor, false,
+                            QString("%1: %2, %3").arg(country, topGenre).arg(topSales));
 
         // Добавляем данные в таблицу
-        model->setItem(row, 0, new QStandardItem(country));
-        model->setItem(row, 1, new QStandardItem(topGenre));
-        model->setItem(row, 2, new QStandardItem(QString::number(topSales, 'f', 2)));
-        row++;
+        table.appendRow({country, topGenre, QString::number(topSales, 'f', 2)});
     }
 
-    // Устанавливаем модель для таблицы
-    ui->tableView->setModel(model);
-    ui->tableView->resizeColumnsToContents();
+    // Устанавливаем данные для таблицы
+    displayTable(table, {"Country", "Top Genre", "Sales"});
+
+    mapScene->endUpdate();
 
     // Добавление легенды
-    AddLegendToScene(scene, genreColors);
+    mapScene->setLegend(genreColors);
 }
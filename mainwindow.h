@@ -1,13 +1,22 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "chartupdater.h"
+#include "mapscene.h"
+#include "queryexecutor.h"
+#include "reports.h"
+#include "resulttablemodel.h"
+#include "salescube.h"
+#include "storageconfig.h"
+#include "timecube.h"
 #include <QMainWindow>
-#include <QSqlDatabase>
-#include <QSqlQuery>
+#include <QSlider>
 #include <QSqlTableModel>
 #include <QTableView>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QComboBox>
+#include <QLabel>
 #include <QMap>
 #include <QtCharts>
 
@@ -22,36 +31,54 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const StorageConfig &storage, QWidget *parent = nullptr);
     ~MainWindow();
 
 private slots:
     void showMonthlySales();
-    void showMonthlySalesChart();
-
     void showRevenueByGenre();
-    void showRevenueByGenreChart();
-
     void showTop3ArtistsByGenre();
-    void showTop3ArtistsByGenreChart();
-
     void showTop5ArtistsOverall();
-    void showTop5ArtistsPentagonChart();
-    void showTop5ArtistsChart();
-
     void showInteractiveMapSum();
-    void showInteractiveMapSumChart();
     void showInteractiveMapGenre();
     void clearScene();
 
 
 private:
     Ui::MainWindow *ui;
-    QSqlDatabase db;
-    void displayTable(QSqlQuery query, const QStringList &headers);
-    void displayMapSum(QMap<QString, QMap<QString, double>> &data);
+    QueryExecutor *executor;
+    ResultTableModel *tableModel;
+    ChartUpdater *chartUpdater;
+    MapScene *mapScene;         // карта и маркеры стран, одна на всё время работы
+    QGraphicsScene *shapeScene; // пятиугольник топ-5, очищается перед отрисовкой
+    SalesCubePtr cube;          // срезы для перекрёстных фильтров, null до загрузки
+    CrossFilter filter;
+    std::function<void()> currentView; // повторяет показ текущего отчёта
+    QLabel *filterLabel;
+    TimeCubePtr timeCube;       // продажи по дням, null до загрузки
+    bool timeSalesShown;
+    QComboBox *granularityBox;
+    QSlider *rangeFromSlider;   // дни от первой даты временного куба
+    QSlider *rangeToSlider;
+    QLabel *rangeLabel;
+    void runReport(ReportId id, const QueryExecutor::Handler &handler, int topPerGroup = 0);
+    void toggleCountryFilter(const QString &country);
+    void toggleGenreFilter(const QString &genre);
+    void applyFilter();
+    void updateRangeLabel();
+    // Выбрана не помесячная гранулярность или не весь диапазон дат
+    bool timeFilterActive() const;
+    void displayTimeSales();
+    void displayPeriodSalesChart(const QVector<PeriodSales> &periods, TimeGranularity granularity);
+    void displayTable(const QueryResult &result, const QStringList &headers);
+    void displayMonthlySalesChart(const QVector<MonthlySales> &rows);
+    void displayRevenueByGenreChart(const QVector<GenreRevenue> &rows);
+    void displayTop3ArtistsByGenreChart(const QVector<ArtistGenreSales> &rows);
+    void displayTop5ArtistsPentagonChart(const QVector<ArtistRevenue> &rows);
+    void displayTop5ArtistsChart(const QVector<ArtistRevenue> &rows);
+    void displayInteractiveMapSumChart(const QVector<CountryRevenue> &rows);
+    void displayMapSum(const QVector<CitySales> &rows);
     QMap<QString, QColor> GenerateGenreColors(const QMap<QString, QMap<QString, double>> &mapData);
-    void AddLegendToScene(QGraphicsScene *scene, const QMap<QString, QColor> &genreColors);
     void displayMapGenre(const QMap<QString, QMap<QString, double>> &mapData);
 
 };
@@ -0,0 +1,53 @@
+#include "mapprojection.h"
+#include <QtMath>
+#include <cmath>
+
+namespace
+{
+
+// Меркатор уходит в бесконечность у полюсов, как и тайлы веб-карт
+const double MercatorLatitudeLimit = 85.05112878;
+
+} // namespace
+
+MapProjection::MapProjection(Kind kind, const QSizeF &mapSize, double northLatitude, double southLatitude,
+                             double westLongitude, double eastLongitude)
+    : projectionKind(kind)
+    , size(mapSize)
+    , west(westLongitude)
+    , east(eastLongitude)
+{
+    top = projectLatitude(northLatitude);
+    bottom = projectLatitude(southLatitude);
+}
+
+MapProjection MapProjection::worldMap(const QSizeF &mapSize)
+{
+    // Определено по ориентирам на карте: долгота на всю ширину, экватор
+    // на 0.49 высоты (y ≈ 258 из 526), сверху и снизу карта обрезана
+    return MapProjection(Miller, mapSize, 76.4, -77.9);
+}
+
+double MapProjection::projectLatitude(double latitude) const
+{
+    switch (projectionKind) {
+    case Equirectangular:
+        return qDegreesToRadians(latitude);
+    case WebMercator: {
+        double phi = qDegreesToRadians(qBound(-MercatorLatitudeLimit, latitude, MercatorLatitudeLimit));
+        return std::log(std::tan(M_PI / 4 + phi / 2));
+    }
+    case Miller: {
+        double phi = qDegreesToRadians(latitude);
+        return 1.25 * std::log(std::tan(M_PI / 4 + 0.4 * phi));
+    }
+    }
+    return 0.0;
+}
+
+QPointF MapProjection::project(double latitude, double longitude) const
+{
+    double x = (longitude - west) / (east - west) * size.width();
+    double y = (top - projectLatitude(latitude)) / (top - bottom) * size.height();
+    return QPointF(x, y);
+}
@@ -0,0 +1,39 @@
+#ifndef MAPPROJECTION_H
+#define MAPPROJECTION_H
+
+#include <QPointF>
+#include <QSizeF>
+
+// Перевод широты и долготы в координаты сцены карты. Карта — прямоугольник
+// mapSize, по горизонтали от westLongitude до eastLongitude, по вертикали
+// от northLatitude до southLatitude (края обрезанной карты)
+class MapProjection
+{
+public:
+    enum Kind { Equirectangular, WebMercator, Miller };
+
+    MapProjection(Kind kind, const QSizeF &mapSize, double northLatitude, double southLatitude,
+                  double westLongitude = -180.0, double eastLongitude = 180.0);
+
+    // Проекция фоновой карты world_map.png: Миллер, обрезанный по широтам.
+    // mapSize — размер карты в координатах сцены
+    static MapProjection worldMap(const QSizeF &mapSize);
+
+    Kind kind() const { return projectionKind; }
+    QSizeF mapSize() const { return size; }
+
+    QPointF project(double latitude, double longitude) const;
+
+private:
+    // Вертикальная координата проекции в радианах, без масштаба карты
+    double projectLatitude(double latitude) const;
+
+    Kind projectionKind;
+    QSizeF size;
+    double west;
+    double east;
+    double top;    // projectLatitude(northLatitude)
+    double bottom; // projectLatitude(southLatitude)
+};
+
+#endif // MAPPROJECTION_H
@@ -0,0 +1,250 @@
+#include "mapscene.h"
+#include "geocoding.h"
+#include "markerlayer.h"
+#include "tilemapitem.h"
+#include <QApplication>
+#include <QBrush>
+#include <QGraphicsRectItem>
+#include <QGraphicsSceneMouseEvent>
+#include <QGraphicsTextItem>
+#include <QImage>
+#include <QPen>
+#include <QDebug>
+
+namespace
+{
+
+// Исходная карта может быть подробнее сцены: тайлы масштабируются в MapSize
+const char *const WorldMapResource = ":/world_map.png";
+
+// Легенда справа от карты, по строке на жанр
+const double LegendX = 900;
+const double LegendY = 50;
+const double LegendStep = 15;
+
+// Кластеры на экране не ближе этого числа пикселей; радиус нижнего
+// уровня иерархии — в единицах сцены. Отдельные города (уровень 0)
+// видны с масштаба ClusterPixelRadius / ClusterBaseRadius = 15
+const qreal ClusterPixelRadius = 30;
+const qreal ClusterBaseRadius = 2;
+
+} // namespace
+
+const QSizeF MapScene::MapSize(961, 526);
+
+MapScene::MapScene(QObject *parent)
+    : QGraphicsScene(parent)
+    , projection(MapProjection::worldMap(MapSize))
+    , clusterLevel(-1)
+    , viewScale(1.0)
+{
+    // Декодируется один раз; пирамида уровней строится здесь же
+    // Фон не элемент сцены, поэтому границы сцены задаются явно
+    background.reset(new TileMapItem(QImage(WorldMapResource), MapSize));
+    setSceneRect(background->boundingRect());
+
+    markers = new MarkerLayer;
+    addItem(markers);
+
+    clusterLayer = new MarkerLayer;
+    clusterLayer->setVisible(false);
+    addItem(clusterLayer);
+}
+
+bool MapScene::countryPosition(const QString &country, QPointF *position)
+{
+    GeoPoint point;
+    if (!Geocoding::instance().country(country, &point)) {
+        if (!reportedMissing.contains(country)) {
+            reportedMissing.insert(country);
+            qDebug() << "Missing coordinates for country:" << country;
+        }
+        return false;
+    }
+    *position = projection.project(point.latitude, point.longitude);
+    return true;
+}
+
+bool MapScene::cityPosition(const QString &country, const QString &city, QPointF *position)
+{
+    GeoPoint point;
+    if (!Geocoding::instance().city(country, city, &point)) {
+        QString name = country + "/" + city;
+        if (!reportedMissing.contains(name)) {
+            reportedMissing.insert(name);
+            qDebug() << "Missing coordinates for city:" << name;
+        }
+        return false;
+    }
+    *position = projection.project(point.latitude, point.longitude);
+    return true;
+}
+
+void MapScene::beginUpdate()
+{
+    clusterLayer->setVisible(false);
+    touched.fill(false, markers->count());
+}
+
+void MapScene::setMarker(const QString &country, const QPointF &center, double diameter, const QColor &color,
+                         bool showLabel, const QString &toolTip)
+{
+    auto it = markerIndex.constFind(country);
+    int index;
+    if (it == markerIndex.constEnd()) {
+        index = markers->addMarker(center, diameter, color, country);
+        markerIndex.insert(country, index);
+        touched.append(false);
+    } else {
+        index = it.value();
+        markers->setMarker(index, center, diameter, color);
+    }
+
+    touched[index] = true;
+    markers->setMarkerVisible(index, true);
+    markers->setLabelVisible(index, showLabel);
+    markers->setToolTipText(index, toolTip.isEmpty() ? country : toolTip);
+}
+
+void MapScene::endUpdate()
+{
+    for (int index = 0; index < touched.size(); ++index) {
+        if (!touched[index]) {
+            markers->setMarkerVisible(index, false);
+        }
+    }
+    markers->commit();
+}
+
+void MapScene::setClusteredMarkers(const QVector<MarkerClusters::Point> &points, const QStringList &countries,
+                                   const ClusterStyle &style)
+{
+    // Маркеры стран скрываются, кластеры живут в своём слое
+    beginUpdate();
+    endUpdate();
+
+    // По маркеру на каждый узел всех уровней; видим только текущий уровень
+    clusters.build(points, ClusterBaseRadius);
+    clusterPointCountries = countries;
+    clusterLayer->clear();
+    clusterLayer->reserve(clusters.nodeCount());
+    for (int node = 0; node < clusters.nodeCount(); ++node) {
+        const MarkerClusters::Point &leader = points.at(clusters.leader(node));
+        qreal diameter = 0;
+        QColor color;
+        style(clusters.value(node), &diameter, &color);
+
+        int others = clusters.pointCount(node) - 1;
+        QString label = others > 0 ? QString("%1 +%2").arg(leader.label).arg(others) : leader.label;
+        QString toolTip = others > 0
+            ? QString("%1 и ещё %2: %3").arg(leader.label).arg(others).arg(clusters.value(node))
+            : QString("%1: %2").arg(leader.label).arg(clusters.value(node));
+
+        int index = clusterLayer->addMarker(clusters.position(node), diameter, color, label);
+        clusterLayer->setMarkerVisible(index, false);
+        clusterLayer->setLabelVisible(index, true);
+        clusterLayer->setToolTipText(index, toolTip);
+    }
+
+    clusterLevel = -1;
+    clusterLayer->setVisible(true);
+    showClusterLevel(clusters.levelForScale(viewScale, ClusterPixelRadius));
+}
+
+void MapScene::setViewScale(qreal scale)
+{
+    viewScale = scale;
+    if (clusterLayer->isVisible()) {
+        showClusterLevel(clusters.levelForScale(viewScale, ClusterPixelRadius));
+    }
+}
+
+void MapScene::showClusterLevel(int level)
+{
+    if (level == clusterLevel || clusters.levelCount() == 0) {
+        return;
+    }
+    // Меняется видимость только узлов старого и нового уровней
+    if (clusterLevel >= 0) {
+        for (int node = clusters.levelBegin(clusterLevel); node < clusters.levelEnd(clusterLevel); ++node) {
+            clusterLayer->setMarkerVisible(node, false);
+        }
+    }
+    for (int node = clusters.levelBegin(level); node < clusters.levelEnd(level); ++node) {
+        clusterLayer->setMarkerVisible(node, true);
+    }
+    clusterLevel = level;
+    clusterLayer->commit();
+}
+
+QString MapScene::countryAt(const QPointF &pos) const
+{
+    if (clusterLayer->isVisible()) {
+        int node = clusterLayer->markerAt(pos);
+        if (node >= 0 && clusters.pointCount(node) == 1) {
+            return clusterPointCountries.value(clusters.leader(node));
+        }
+        return QString();
+    }
+    int index = markers->markerAt(pos);
+    return index >= 0 ? markers->label(index) : QString();
+}
+
+MapScene::~MapScene()
+{
+}
+
+void MapScene::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsScene::drawBackground(painter, rect);
+    background->paintTiles(painter, rect);
+}
+
+void MapScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    // Щелчок без перетаскивания карты выбирает страну под курсором
+    if (event->button() == Qt::LeftButton) {
+        QPoint moved = event->screenPos() - event->buttonDownScreenPos(Qt::LeftButton);
+        if (moved.manhattanLength() < QApplication::startDragDistance()) {
+            QString country = countryAt(event->scenePos());
+            if (!country.isEmpty()) {
+                emit countryClicked(country);
+            }
+        }
+    }
+    QGraphicsScene::mouseReleaseEvent(event);
+}
+
+void MapScene::hideMarkers()
+{
+    beginUpdate();
+    endUpdate();
+    setLegend(QMap<QString, QColor>());
+}
+
+void MapScene::setLegend(const QMap<QString, QColor> &colors)
+{
+    int row = 0;
+    for (auto it = colors.constBegin(); it != colors.constEnd(); ++it, ++row) {
+        if (row == legend.size()) {
+            LegendEntry entry;
+            entry.swatch = addRect(0, 0, 20, 20, QPen(Qt::NoPen));
+            entry.label = addText(QString());
+            legend.append(entry);
+        }
+        double y = LegendY + row * LegendStep;
+        LegendEntry &entry = legend[row];
+        entry.swatch->setPos(LegendX, y);
+        entry.swatch->setBrush(QBrush(it.value()));
+        entry.swatch->setVisible(true);
+        entry.label->setPlainText(it.key());
+        entry.label->setPos(LegendX + 30, y);
+        entry.label->setVisible(true);
+    }
+    for (; row < legend.size(); ++row) {
+        legend[row].swatch->setVisible(false);
+        legend[row].label->setVisible(false);
+    }
+    // Подписи легенды могут выходить за правый край карты
+    setSceneRect(background->boundingRect() | itemsBoundingRect());
+}
@@ -0,0 +1,99 @@
+#ifndef MAPSCENE_H
+#define MAPSCENE_H
+
+#include "mapprojection.h"
+#include "markerclusters.h"
+#include <QGraphicsScene>
+#include <QHash>
+#include <QMap>
+#include <QScopedPointer>
+#include <QSet>
+#include <QSizeF>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+class MarkerLayer;
+class QGraphicsSceneMouseEvent;
+class QGraphicsRectItem;
+class QGraphicsTextItem;
+class TileMapItem;
+
+// Постоянная сцена карты. Фон — пирамида тайлов (см. TileMapItem), он
+// рисуется в drawBackground, чтобы вид мог кэшировать его растром;
+// маркеры — один пакетный слой (см. MarkerLayer). Маркеры стран живут всё
+// время работы и при смене режима только меняют размер, цвет и видимость.
+// Режим с кластерами рисует отдельный слой, где уровень иерархии
+// MarkerClusters выбирается по масштабу вида
+class MapScene : public QGraphicsScene
+{
+    Q_OBJECT
+
+public:
+    // Размер карты в координатах сцены, в которых заданы маркеры стран
+    static const QSizeF MapSize;
+
+    explicit MapScene(QObject *parent = nullptr);
+    ~MapScene() override;
+
+    // Положение страны или города на карте по таблице геокодирования.
+    // Об отсутствующих названиях сообщается в лог один раз
+    bool countryPosition(const QString &country, QPointF *position);
+    bool cityPosition(const QString &country, const QString &city, QPointF *position);
+    const MapProjection &mapProjection() const { return projection; }
+
+    // Между beginUpdate и endUpdate задаются маркеры текущего режима;
+    // маркеры, которые не обновлялись, скрываются
+    void beginUpdate();
+    void setMarker(const QString &country, const QPointF &center, double diameter, const QColor &color,
+                   bool showLabel, const QString &toolTip = QString());
+    void endUpdate();
+
+    // Размер и цвет маркера кластера по сумме значений его точек
+    typedef std::function<void(double value, qreal *diameter, QColor *color)> ClusterStyle;
+
+    // Точки (города) показываются кластерами вместо маркеров стран. Иерархия
+    // строится здесь; при смене масштаба переключается только уровень.
+    // countries — страна каждой точки, её выбирает щелчок по точке
+    void setClusteredMarkers(const QVector<MarkerClusters::Point> &points, const QStringList &countries,
+                             const ClusterStyle &style);
+    void setViewScale(qreal scale);
+
+    void hideMarkers();
+    void setLegend(const QMap<QString, QColor> &colors);
+
+    // Страна видимого маркера в точке сцены; у кластера из нескольких
+    // стран — пустая строка
+    QString countryAt(const QPointF &pos) const;
+
+signals:
+    void countryClicked(const QString &country);
+
+protected:
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+
+private:
+    void showClusterLevel(int level);
+
+    struct LegendEntry
+    {
+        QGraphicsRectItem *swatch;
+        QGraphicsTextItem *label;
+    };
+
+    MapProjection projection;
+    QSet<QString> reportedMissing;
+    QScopedPointer<TileMapItem> background; // не элемент сцены, рисуется как фон
+    MarkerLayer *markers;
+    QHash<QString, int> markerIndex; // страна -> индекс в слое
+    QVector<bool> touched;
+    MarkerLayer *clusterLayer;
+    MarkerClusters clusters;
+    QStringList clusterPointCountries;
+    int clusterLevel; // показанный уровень или -1
+    qreal viewScale;
+    QVector<LegendEntry> legend;
+};
+
+#endif // MAPSCENE_H
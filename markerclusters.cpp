@@ -0,0 +1,142 @@
+#include "markerclusters.h"
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Больше уровней не нужно: радиус растёт вдвое на каждом
+const int MaxLevels = 24;
+
+quint64 cellKey(qint64 column, qint64 row)
+{
+    return (quint64(quint32(column)) << 32) | quint32(row);
+}
+
+} // namespace
+
+void MarkerClusters::clear()
+{
+    levelStart.clear();
+    xs.clear();
+    ys.clear();
+    values.clear();
+    counts.clear();
+    leaders.clear();
+    parents.clear();
+}
+
+void MarkerClusters::build(const QVector<Point> &points, qreal baseRadius)
+{
+    clear();
+    base = baseRadius;
+    levelStart.append(0);
+    for (int i = 0; i < points.size(); ++i) {
+        appendNode(points[i].position.x(), points[i].position.y(), points[i].value, 1, i);
+    }
+    levelStart.append(xs.size());
+
+    // Строим уровни, пока всё не сольётся в один кластер
+    for (int level = 1; level < MaxLevels && levelEnd(level - 1) - levelBegin(level - 1) > 1; ++level) {
+        buildLevel(level);
+    }
+}
+
+int MarkerClusters::appendNode(qreal x, qreal y, double value, int count, int leader)
+{
+    xs.append(x);
+    ys.append(y);
+    values.append(value);
+    counts.append(count);
+    leaders.append(leader);
+    parents.append(-1);
+    return xs.size() - 1;
+}
+
+void MarkerClusters::buildLevel(int level)
+{
+    int begin = levelBegin(level - 1);
+    int end = levelEnd(level - 1);
+    qreal r = radius(level);
+
+    // Сетка с ячейкой r: соседи в радиусе r лежат в соседних 3x3 ячейках
+    QHash<quint64, QVector<int>> cells;
+    for (int node = begin; node < end; ++node) {
+        cells[cellKey(qint64(std::floor(xs[node] / r)), qint64(std::floor(ys[node] / r)))].append(node);
+    }
+
+    // Жадно: самый крупный свободный узел забирает свободных соседей
+    QVector<int> order;
+    order.reserve(end - begin);
+    for (int node = begin; node < end; ++node) {
+        order.append(node);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return values[a] > values[b]; });
+
+    for (int seed : order) {
+        if (parents[seed] >= 0) {
+            continue;
+        }
+        qint64 column = qint64(std::floor(xs[seed] / r));
+        qint64 row = qint64(std::floor(ys[seed] / r));
+        QVector<int> members;
+        members.append(seed);
+        for (qint64 dy = -1; dy <= 1; ++dy) {
+            for (qint64 dx = -1; dx <= 1; ++dx) {
+                auto it = cells.constFind(cellKey(column + dx, row + dy));
+                if (it == cells.constEnd()) {
+                    continue;
+                }
+                for (int node : it.value()) {
+                    if (node == seed || parents[node] >= 0) {
+                        continue;
+                    }
+                    qreal ddx = xs[node] - xs[seed];
+                    qreal ddy = ys[node] - ys[seed];
+                    if (ddx * ddx + ddy * ddy <= r * r) {
+                        members.append(node);
+                    }
+                }
+            }
+        }
+
+        // Центр взвешен по значению; при нулевых значениях — по числу точек
+        double total = 0;
+        int count = 0;
+        for (int node : members) {
+            total += values[node];
+            count += counts[node];
+        }
+        qreal x = 0;
+        qreal y = 0;
+        for (int node : members) {
+            qreal weight = total > 0 ? values[node] / total : qreal(counts[node]) / count;
+            x += xs[node] * weight;
+            y += ys[node] * weight;
+        }
+        int cluster = appendNode(x, y, total, count, leaders[seed]);
+        for (int node : members) {
+            parents[node] = cluster;
+        }
+    }
+    levelStart.append(xs.size());
+}
+
+qreal MarkerClusters::radius(int level) const
+{
+    return level <= 0 ? 0.0 : std::ldexp(base, level - 1);
+}
+
+int MarkerClusters::levelForScale(qreal scale, qreal pixelRadius) const
+{
+    if (levelCount() <= 1 || scale <= 0) {
+        return qMax(0, levelCount() - 1);
+    }
+    // Наименьший уровень с radius(level) >= pixelRadius / scale. Если уже
+    // radius(1) на экране не меньше pixelRadius, точки показываются как есть:
+    // слить на уровне 1 можно только почти совпадающие точки
+    qreal needed = pixelRadius / scale;
+    int level = needed <= base ? 0 : int(std::ceil(std::log2(needed / base))) + 1;
+    return qBound(0, level, levelCount() - 1);
+}
@@ -0,0 +1,59 @@
+#ifndef MARKERCLUSTERS_H
+#define MARKERCLUSTERS_H
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+// Иерархия кластеров точек карты, строится один раз на набор данных.
+// Уровень 0 — сами точки; на уровне k > 0 объединяются кластеры уровня
+// k - 1, центры которых ближе radius(k) = baseRadius * 2^(k - 1).
+// Значения кластера суммируются, центр — среднее, взвешенное по значению.
+// При масштабировании выбирается готовый уровень, поэтому число видимых
+// кластеров ограничено площадью окна, а не размером данных
+class MarkerClusters
+{
+public:
+    struct Point
+    {
+        QPointF position;
+        double value;
+        QString label;
+    };
+
+    void build(const QVector<Point> &points, qreal baseRadius);
+    void clear();
+
+    int levelCount() const { return levelStart.size() - 1; }
+    qreal radius(int level) const;
+
+    // Уровень, на котором кластеры не ближе pixelRadius пикселей экрана
+    int levelForScale(qreal scale, qreal pixelRadius) const;
+
+    // Узлы уровня — непрерывный диапазон [levelBegin, levelEnd)
+    int levelBegin(int level) const { return levelStart.at(level); }
+    int levelEnd(int level) const { return levelStart.at(level + 1); }
+    int nodeCount() const { return xs.size(); }
+
+    QPointF position(int node) const { return QPointF(xs.at(node), ys.at(node)); }
+    double value(int node) const { return values.at(node); }
+    int pointCount(int node) const { return counts.at(node); }
+    // Точка с наибольшим значением внутри кластера
+    int leader(int node) const { return leaders.at(node); }
+    int parent(int node) const { return parents.at(node); }
+
+private:
+    void buildLevel(int level);
+    int appendNode(qreal x, qreal y, double value, int count, int leader);
+
+    qreal base = 1.0;
+    QVector<int> levelStart;
+    QVector<qreal> xs;
+    QVector<qreal> ys;
+    QVector<double> values;
+    QVector<int> counts;
+    QVector<int> leaders;
+    QVector<int> parents; // -1 у узлов верхнего уровня
+};
+
+#endif // MARKERCLUSTERS_H
@@ -0,0 +1,270 @@
+#include "markerlayer.h"
+#include "tracing.h"
+#include <QFontMetricsF>
+#include <QGraphicsSceneHoverEvent>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Подпись рисуется справа снизу от круга; запас нужен для отсечения
+const qreal LabelWidth = 200;
+const qreal LabelHeight = 30;
+const qreal LabelOffset = 4;
+
+// В среднем несколько маркеров на ячейку, но не больше MaxGridSide ячеек по стороне
+const int MarkersPerCell = 4;
+const int MaxGridSide = 1024;
+const qreal MinCellSize = 4;
+
+// Маркеры мельче этого числа пикселей экрана рисуются квадратом
+const qreal MinDevicePixels = 2;
+
+} // namespace
+
+MarkerLayer::MarkerLayer(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , cellSize(MinCellSize)
+    , gridColumns(0)
+    , gridRows(0)
+    , maxDiameter(0)
+{
+    setFlag(ItemUsesExtendedStyleOption);
+    setAcceptHoverEvents(true);
+}
+
+void MarkerLayer::clear()
+{
+    xs.clear();
+    ys.clear();
+    diameters.clear();
+    colors.clear();
+    flags.clear();
+    labels.clear();
+    toolTips.clear();
+    commit();
+}
+
+void MarkerLayer::reserve(int size)
+{
+    xs.reserve(size);
+    ys.reserve(size);
+    diameters.reserve(size);
+    colors.reserve(size);
+    flags.reserve(size);
+    labels.reserve(size);
+    toolTips.reserve(size);
+}
+
+int MarkerLayer::addMarker(const QPointF &center, qreal diameter, const QColor &color, const QString &label)
+{
+    xs.append(float(center.x()));
+    ys.append(float(center.y()));
+    diameters.append(float(diameter));
+    colors.append(color.rgba());
+    flags.append(Visible);
+    labels.append(label);
+    toolTips.append(label);
+    return xs.size() - 1;
+}
+
+void MarkerLayer::setMarker(int index, const QPointF &center, qreal diameter, const QColor &color)
+{
+    xs[index] = float(center.x());
+    ys[index] = float(center.y());
+    diameters[index] = float(diameter);
+    colors[index] = color.rgba();
+}
+
+void MarkerLayer::setMarkerVisible(int index, bool visible)
+{
+    flags[index] = quint8(visible ? (flags[index] | Visible) : (flags[index] & ~Visible));
+}
+
+void MarkerLayer::setLabelVisible(int index, bool visible)
+{
+    flags[index] = quint8(visible ? (flags[index] | LabelVisible) : (flags[index] & ~LabelVisible));
+}
+
+void MarkerLayer::setToolTipText(int index, const QString &text)
+{
+    toolTips[index] = text;
+}
+
+void MarkerLayer::commit()
+{
+    TRACE_SCOPE("MarkerLayer::commit");
+    Tracing::counter("markers", xs.size());
+    prepareGeometryChange();
+
+    // Границы по центрам и наибольший диаметр
+    maxDiameter = 0;
+    qreal left = 0, top = 0, right = 0, bottom = 0;
+    bool first = true;
+    for (int i = 0; i < xs.size(); ++i) {
+        if (!(flags[i] & Visible)) {
+            continue;
+        }
+        if (first) {
+            left = right = xs[i];
+            top = bottom = ys[i];
+            first = false;
+        }
+        left = qMin<qreal>(left, xs[i]);
+        right = qMax<qreal>(right, xs[i]);
+        top = qMin<qreal>(top, ys[i]);
+        bottom = qMax<qreal>(bottom, ys[i]);
+        maxDiameter = qMax(maxDiameter, diameters[i]);
+    }
+    gridBounds = first ? QRectF() : QRectF(QPointF(left, top), QPointF(right, bottom));
+    qreal half = maxDiameter / 2;
+    bounds = first ? QRectF()
+                   : gridBounds.adjusted(-half, -half, half + LabelOffset + LabelWidth, half + LabelOffset + LabelHeight);
+
+    // Сетка по центрам видимых маркеров
+    int visibleCount = 0;
+    for (quint8 flag : flags) {
+        visibleCount += (flag & Visible) ? 1 : 0;
+    }
+    qreal area = qMax<qreal>(gridBounds.width() * gridBounds.height(), MinCellSize * MinCellSize);
+    int wantedCells = qMax(1, visibleCount / MarkersPerCell);
+    cellSize = qMax(MinCellSize, std::sqrt(area / wantedCells));
+    cellSize = qMax(cellSize, qMax(gridBounds.width(), gridBounds.height()) / MaxGridSide);
+    gridColumns = int(gridBounds.width() / cellSize) + 1;
+    gridRows = int(gridBounds.height() / cellSize) + 1;
+
+    cellStart.fill(0, gridColumns * gridRows + 1);
+    QVector<int> cellOf(xs.size(), -1);
+    for (int i = 0; i < xs.size(); ++i) {
+        if (!(flags[i] & Visible)) {
+            continue;
+        }
+        int column = int((xs[i] - gridBounds.left()) / cellSize);
+        int row = int((ys[i] - gridBounds.top()) / cellSize);
+        cellOf[i] = row * gridColumns + column;
+        ++cellStart[cellOf[i] + 1];
+    }
+    for (int cell = 0; cell < gridColumns * gridRows; ++cell) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    cellItems.resize(visibleCount);
+    QVector<int> fill = cellStart;
+    for (int i = 0; i < xs.size(); ++i) {
+        if (cellOf[i] >= 0) {
+            cellItems[fill[cellOf[i]]++] = i;
+        }
+    }
+
+    update();
+}
+
+template <typename Visitor>
+void MarkerLayer::forEachInRect(const QRectF &rect, Visitor visit) const
+{
+    if (cellItems.isEmpty()) {
+        return;
+    }
+    if (rect.right() < gridBounds.left() || rect.left() > gridBounds.right()
+            || rect.bottom() < gridBounds.top() || rect.top() > gridBounds.bottom()) {
+        return;
+    }
+    int firstColumn = qBound(0, int((rect.left() - gridBounds.left()) / cellSize), gridColumns - 1);
+    int lastColumn = qBound(0, int((rect.right() - gridBounds.left()) / cellSize), gridColumns - 1);
+    int firstRow = qBound(0, int((rect.top() - gridBounds.top()) / cellSize), gridRows - 1);
+    int lastRow = qBound(0, int((rect.bottom() - gridBounds.top()) / cellSize), gridRows - 1);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            int cell = row * gridColumns + column;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                visit(cellItems[k]);
+            }
+        }
+    }
+}
+
+int MarkerLayer::markerAt(const QPointF &pos) const
+{
+    qreal half = maxDiameter / 2;
+    int found = -1;
+    forEachInRect(QRectF(pos.x() - half, pos.y() - half, 2 * half, 2 * half), [&](int i) {
+        qreal dx = pos.x() - xs[i];
+        qreal dy = pos.y() - ys[i];
+        qreal radius = diameters[i] / 2;
+        // Сверху рисуется маркер с большим индексом
+        if (dx * dx + dy * dy <= radius * radius && i > found) {
+            found = i;
+        }
+    });
+    return found;
+}
+
+QRectF MarkerLayer::boundingRect() const
+{
+    return bounds;
+}
+
+void MarkerLayer::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    if (cellItems.isEmpty()) {
+        return;
+    }
+    TRACE_SCOPE("MarkerLayer::paint");
+
+    qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    qreal half = maxDiameter / 2;
+    QRectF exposed = option->exposedRect;
+
+    // Кандидаты по сетке: центр может лежать левее/выше области на радиус
+    // и на ширину подписи. Если видна вся сетка, сортировка не нужна
+    QRectF query = exposed.adjusted(-half - LabelOffset - LabelWidth, -half - LabelOffset - LabelHeight, half, half);
+    QVector<int> visible;
+    if (query.contains(gridBounds)) {
+        visible = cellItems;
+    } else {
+        forEachInRect(query, [&](int i) { visible.append(i); });
+    }
+    // Порядок отрисовки совпадает с порядком добавления
+    std::sort(visible.begin(), visible.end());
+
+    painter->save();
+    painter->setPen(Qt::NoPen);
+    QRgb currentColor = 0;
+    bool brushSet = false;
+    qreal minSize = MinDevicePixels / lod;
+    for (int i : visible) {
+        if (!brushSet || colors[i] != currentColor) {
+            currentColor = colors[i];
+            painter->setBrush(QColor::fromRgba(currentColor));
+            brushSet = true;
+        }
+        qreal d = diameters[i];
+        if (d < minSize) {
+            painter->drawRect(QRectF(xs[i] - minSize / 2, ys[i] - minSize / 2, minSize, minSize));
+        } else {
+            painter->drawEllipse(QRectF(xs[i] - d / 2, ys[i] - d / 2, d, d));
+        }
+    }
+
+    // Подписи поверх кругов
+    painter->setPen(Qt::black);
+    qreal ascent = QFontMetricsF(painter->font()).ascent();
+    for (int i : visible) {
+        if (flags[i] & LabelVisible) {
+            qreal offset = diameters[i] / 2 + LabelOffset;
+            painter->drawText(QPointF(xs[i] + offset, ys[i] + offset + ascent), labels[i]);
+        }
+    }
+    painter->restore();
+    Tracing::counter("markers painted", visible.size());
+}
+
+void MarkerLayer::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    int index = markerAt(event->pos());
+    setToolTip(index >= 0 ? toolTips.at(index) : QString());
+    QGraphicsItem::hoverMoveEvent(event);
+}
@@ -0,0 +1,69 @@
+#ifndef MARKERLAYER_H
+#define MARKERLAYER_H
+
+#include <QColor>
+#include <QGraphicsItem>
+#include <QStringList>
+#include <QVector>
+
+// Слой маркеров карты: один QGraphicsItem рисует все круги из массивов
+// структуры (координаты, диаметры, цвета, флаги лежат раздельно).
+// Равномерная сетка по центрам маркеров используется для отсечения при
+// отрисовке, поиска маркера под курсором и подсказок
+class MarkerLayer : public QGraphicsItem
+{
+public:
+    explicit MarkerLayer(QGraphicsItem *parent = nullptr);
+
+    int count() const { return xs.size(); }
+    void clear();
+    void reserve(int size);
+
+    // Изменения вступают в силу после commit(): он перестраивает сетку
+    // и границы слоя
+    int addMarker(const QPointF &center, qreal diameter, const QColor &color, const QString &label);
+    void setMarker(int index, const QPointF &center, qreal diameter, const QColor &color);
+    void setMarkerVisible(int index, bool visible);
+    void setLabelVisible(int index, bool visible);
+    void setToolTipText(int index, const QString &text);
+    void commit();
+
+    QString label(int index) const { return labels.at(index); }
+    QPointF center(int index) const { return QPointF(xs.at(index), ys.at(index)); }
+
+    // Индекс верхнего видимого маркера, содержащего точку, или -1
+    int markerAt(const QPointF &pos) const;
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event) override;
+
+private:
+    enum Flag : quint8 { Visible = 1, LabelVisible = 2 };
+
+    template <typename Visitor>
+    void forEachInRect(const QRectF &rect, Visitor visit) const;
+
+    // Структура массивов: по элементу на маркер
+    QVector<float> xs;
+    QVector<float> ys;
+    QVector<float> diameters;
+    QVector<QRgb> colors;
+    QVector<quint8> flags;
+    QStringList labels;
+    QStringList toolTips;
+
+    // Сетка в формате CSR: маркеры ячейки i — cellItems[cellStart[i]..cellStart[i + 1])
+    QRectF gridBounds;
+    qreal cellSize;
+    int gridColumns;
+    int gridRows;
+    QVector<int> cellStart;
+    QVector<int> cellItems;
+    float maxDiameter;
+    QRectF bounds;
+};
+
+#endif // MARKERLAYER_H
@@ -0,0 +1,331 @@
+#include "partitionedaggregator.h"
+#include <QHash>
+#include <QRunnable>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace
+{
+
+// Частичные агрегаты по диапазону (:from, :to] счетов: столбцы группы,
+// затем SUM(Quantity) и неокруглённая SUM(Quantity * UnitPrice).
+// Соединения совпадают с исходными отчётами
+const char *partialSql(ReportId report)
+{
+    switch (report) {
+    case ReportId::MonthlySales:
+        return R"(
+            SELECT strftime('%Y-%m', invoices.InvoiceDate) AS Month,
+                   SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+            FROM invoice_items
+            JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+            WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+            GROUP BY Month)";
+    case ReportId::RevenueByGenre:
+        return R"(
+            SELECT genres.GenreId, genres.Name,
+                   SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+            FROM invoice_items
+            JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+            JOIN genres ON tracks.GenreId = genres.GenreId
+            WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+            GROUP BY genres.GenreId)";
+    case ReportId::ArtistsByGenre:
+        return R"(
+            SELECT genres.GenreId, artists.ArtistId, genres.Name, artists.Name,
+                   SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+            FROM invoice_items
+            JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+            JOIN albums ON tracks.AlbumId = albums.AlbumId
+            JOIN artists ON albums.ArtistId = artists.ArtistId
+            JOIN genres ON tracks.GenreId = genres.GenreId
+            WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+            GROUP BY genres.GenreId, artists.ArtistId)";
+    case ReportId::TopArtists:
+        return R"(
+            SELECT artists.ArtistId, artists.Name,
+                   SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+            FROM invoice_items
+            JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+            JOIN albums ON tracks.AlbumId = albums.AlbumId
+            JOIN artists ON albums.ArtistId = artists.ArtistId
+            WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+            GROUP BY artists.ArtistId)";
+    case ReportId::SalesByCountryGenre:
+        return R"(
+            SELECT invoices.BillingCountry, genres.GenreId, genres.Name,
+                   SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+            FROM invoice_items
+            JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+            JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+            JOIN genres ON tracks.GenreId = genres.GenreId
+            WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+            GROUP BY invoices.BillingCountry, genres.GenreId)";
+    case ReportId::SalesByCity:
+        return R"(
+            SELECT invoices.BillingCountry, invoices.BillingCity,
+                   SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+            FROM invoice_items
+            JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+            WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+            GROUP BY invoices.BillingCountry, invoices.BillingCity)";
+    }
+    return nullptr;
+}
+
+struct GroupRow
+{
+    QVector<QVariant> keys;
+    qint64 quantity = 0;
+    double revenue = 0.0;
+};
+
+struct Partial
+{
+    QVector<GroupRow> rows;
+    QString error;
+    bool cancelled = false;
+};
+
+class PartitionTask : public QRunnable
+{
+public:
+    PartitionTask(ConnectionPool *connections, const QString &sql, qint64 fromInvoiceId, qint64 toInvoiceId,
+                  const QAtomicInt &cancel, Partial *out)
+        : connections(connections)
+        , sql(sql)
+        , fromInvoiceId(fromInvoiceId)
+        , toInvoiceId(toInvoiceId)
+        , cancel(cancel)
+        , out(out)
+    {
+    }
+
+    void run() override
+    {
+        QSqlDatabase db = connections->database(&out->error);
+        if (db.isOpen()) {
+            scan(db);
+        }
+    }
+
+private:
+    void scan(QSqlDatabase &db)
+    {
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare(sql);
+        query.bindValue(":from", fromInvoiceId);
+        query.bindValue(":to", toInvoiceId);
+        if (!query.exec()) {
+            out->error = query.lastError().text();
+            return;
+        }
+
+        int keyCount = query.record().count() - 2;
+        while (query.next()) {
+            if (cancel.load()) {
+                out->cancelled = true;
+                return;
+            }
+            GroupRow row;
+            row.keys.reserve(keyCount);
+            for (int col = 0; col < keyCount; ++col) {
+                row.keys.append(query.value(col));
+            }
+            row.quantity = query.value(keyCount).toLongLong();
+            row.revenue = query.value(keyCount + 1).toDouble();
+            out->rows.append(row);
+        }
+    }
+
+    ConnectionPool *connections;
+    QString sql;
+    qint64 fromInvoiceId;
+    qint64 toInvoiceId;
+    const QAtomicInt &cancel;
+    Partial *out;
+};
+
+// Слияние частичных сумм по полному набору столбцов группы
+QVector<GroupRow> merge(const QVector<Partial> &partials)
+{
+    QVector<GroupRow> merged;
+    QHash<QString, int> index;
+    for (const Partial &partial : partials) {
+        for (const GroupRow &row : partial.rows) {
+            QStringList parts;
+            for (const QVariant &key : row.keys) {
+                parts << key.toString();
+            }
+            QString key = parts.join(QChar(0x1f));
+            auto it = index.constFind(key);
+            if (it == index.constEnd()) {
+                index.insert(key, merged.size());
+                merged.append(row);
+            } else {
+                GroupRow &target = merged[it.value()];
+                target.quantity += row.quantity;
+                target.revenue += row.revenue;
+            }
+        }
+    }
+    return merged;
+}
+
+// Финальные столбцы, округление и порядок — как в SQL-отчётах
+QueryResult finish(ReportId report, QVector<GroupRow> rows)
+{
+    QueryResult result;
+    switch (report) {
+    case ReportId::MonthlySales:
+        std::sort(rows.begin(), rows.end(), [](const GroupRow &a, const GroupRow &b) {
+            return a.keys[0].toString() < b.keys[0].toString();
+        });
+        result.columns << "Month" << "TotalSales";
+        for (const GroupRow &row : rows) {
+            result.appendRow({row.keys[0], row.quantity});
+        }
+        break;
+    case ReportId::RevenueByGenre:
+        for (GroupRow &row : rows) {
+            row.revenue = Reports::roundToCents(row.revenue);
+        }
+        std::stable_sort(rows.begin(), rows.end(), [](const GroupRow &a, const GroupRow &b) {
+            return a.revenue > b.revenue;
+        });
+        result.columns << "GenreName" << "Revenue";
+        for (const GroupRow &row : rows) {
+            result.appendRow({row.keys[1], row.revenue});
+        }
+        break;
+    case ReportId::ArtistsByGenre:
+        std::sort(rows.begin(), rows.end(), [](const GroupRow &a, const GroupRow &b) {
+            int order = a.keys[2].toString().compare(b.keys[2].toString());
+            if (order != 0) {
+                return order < 0;
+            }
+            return a.quantity > b.quantity;
+        });
+        result.columns << "GenreName" << "ArtistName" << "TotalSales";
+        for (const GroupRow &row : rows) {
+            result.appendRow({row.keys[2], row.keys[3], row.quantity});
+        }
+        break;
+    case ReportId::TopArtists: {
+        for (GroupRow &row : rows) {
+            row.revenue = Reports::roundToCents(row.revenue);
+        }
+        int count = qMin(5, rows.size());
+        std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [](const GroupRow &a, const GroupRow &b) {
+            return a.revenue > b.revenue;
+        });
+        result.columns << "ArtistName" << "TotalQuantity" << "TotalSales";
+        for (int i = 0; i < count; ++i) {
+            result.appendRow({rows[i].keys[1], rows[i].quantity, rows[i].revenue});
+        }
+        break;
+    }
+    case ReportId::SalesByCountryGenre:
+        std::sort(rows.begin(), rows.end(), [](const GroupRow &a, const GroupRow &b) {
+            int order = a.keys[0].toString().compare(b.keys[0].toString());
+            if (order != 0) {
+                return order < 0;
+            }
+            if (a.quantity != b.quantity) {
+                return a.quantity > b.quantity;
+            }
+            return a.keys[2].toString() < b.keys[2].toString();
+        });
+        result.columns << "BillingCountry" << "GenreName" << "TotalQuantity" << "TotalSales";
+        for (const GroupRow &row : rows) {
+            result.appendRow({row.keys[0], row.keys[2], row.quantity, Reports::roundToCents(row.revenue)});
+        }
+        break;
+    case ReportId::SalesByCity:
+        std::sort(rows.begin(), rows.end(), [](const GroupRow &a, const GroupRow &b) {
+            int order = a.keys[0].toString().compare(b.keys[0].toString());
+            if (order != 0) {
+                return order < 0;
+            }
+            return a.keys[1].toString() < b.keys[1].toString();
+        });
+        result.columns << "BillingCountry" << "BillingCity" << "TotalQuantity" << "TotalSales";
+        for (const GroupRow &row : rows) {
+            result.appendRow({row.keys[0], row.keys[1], row.quantity, Reports::roundToCents(row.revenue)});
+        }
+        break;
+    }
+    return result;
+}
+
+} // namespace
+
+PartitionedAggregator::PartitionedAggregator(const ConnectionPoolPtr &connections, int partitions)
+    : connections(connections)
+    , partitions(partitions > 0 ? partitions : qMax(1, QThread::idealThreadCount()))
+{
+}
+
+PartitionedAggregator::~PartitionedAggregator()
+{
+}
+
+bool PartitionedAggregator::supports(ReportId report) const
+{
+    return partialSql(report) != nullptr;
+}
+
+QueryResult PartitionedAggregator::run(QSqlDatabase &db, ReportId report, const QAtomicInt &cancel)
+{
+    QueryResult result;
+
+    qint64 minInvoiceId = 0;
+    qint64 maxInvoiceId = 0;
+    {
+        QSqlQuery query(db);
+        if (!query.exec("SELECT MIN(InvoiceId), MAX(InvoiceId) FROM invoice_items") || !query.next()) {
+            result.error = query.lastError().text();
+            return result;
+        }
+        minInvoiceId = query.value(0).toLongLong();
+        maxInvoiceId = query.value(1).toLongLong();
+    }
+
+    // Равные диапазоны (from, to]; первый начинается перед минимальным счётом
+    qint64 span = maxInvoiceId - minInvoiceId + 1;
+    qint64 step = qMax<qint64>(1, (span + partitions - 1) / partitions);
+    int taskCount = int(qMin<qint64>(partitions, (span + step - 1) / step));
+
+    if (!pool) {
+        // Потоки не завершаются по простою, чтобы не терять их соединения
+        pool.reset(new QThreadPool);
+        pool->setMaxThreadCount(partitions);
+        pool->setExpiryTimeout(-1);
+    }
+
+    QVector<Partial> partials(taskCount);
+    QString sql = partialSql(report);
+    for (int i = 0; i < taskCount; ++i) {
+        qint64 from = minInvoiceId - 1 + i * step;
+        qint64 to = (i == taskCount - 1) ? maxInvoiceId : from + step;
+        pool->start(new PartitionTask(connections.data(), sql, from, to, cancel, &partials[i]));
+    }
+    pool->waitForDone();
+
+    for (const Partial &partial : partials) {
+        if (partial.cancelled || cancel.load()) {
+            result.cancelled = true;
+            return result;
+        }
+        if (!partial.error.isEmpty()) {
+            result.error = partial.error;
+            return result;
+        }
+    }
+    return finish(report, merge(partials));
+}
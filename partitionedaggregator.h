@@ -0,0 +1,38 @@
+#ifndef PARTITIONEDAGGREGATOR_H
+#define PARTITIONEDAGGREGATOR_H
+
+#include "queryresult.h"
+#include "reports.h"
+#include "storageconfig.h"
+#include <QAtomicInt>
+#include <QSqlDatabase>
+#include <QString>
+#include <QScopedPointer>
+
+class QThreadPool;
+
+// Параллельное выполнение агрегатных отчётов. invoice_items делится на
+// диапазоны InvoiceId по числу ядер; каждый диапазон считается в пуле потоков
+// через соединение пула своего потока, частичные суммы затем сливаются,
+// округляются и сортируются так же, как в SQL-отчётах. Потоки и их
+// соединения живут между вызовами
+class PartitionedAggregator
+{
+public:
+    explicit PartitionedAggregator(const ConnectionPoolPtr &connections, int partitions = 0);
+    ~PartitionedAggregator();
+
+    bool supports(ReportId report) const;
+    int partitionCount() const { return partitions; }
+
+    // db — соединение вызывающего потока, через него выбираются границы
+    // диапазонов. Отмена проверяется в каждом потоке на каждой строке
+    QueryResult run(QSqlDatabase &db, ReportId report, const QAtomicInt &cancel);
+
+private:
+    ConnectionPoolPtr connections;    // удаляется после потоков пула и их соединений
+    int partitions;
+    QScopedPointer<QThreadPool> pool; // создаётся в потоке, который вызывает run()
+};
+
+#endif // PARTITIONEDAGGREGATOR_H
@@ -0,0 +1,436 @@
+#include "queryexecutor.h"
+#include "tracing.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QDebug>
+
+QueryWorker::QueryWorker(const ConnectionPoolPtr &connections, const QueryInterruptPtr &interrupter)
+    : connections(connections)
+    , interrupter(interrupter)
+    , dialect(connections->config().dialect)
+    , engine(ExecutionEngine::Sql)
+    , partitioned(connections)
+    , approximateTopK(true)
+{
+}
+
+void QueryWorker::open()
+{
+    // Соединение создаётся в рабочем потоке и используется только в нём
+    QString error;
+    QSqlDatabase db = connections->database(&error);
+    if (!db.isOpen()) {
+        emit errorOccurred(error);
+        return;
+    }
+    connectionName = db.connectionName();
+    interrupter->attach(db);
+
+    // SQL отчётов разбирается один раз при открытии соединения. Запросы
+    // по агрегатам готовятся при первом использовании: таблиц rollup_*
+    // до первого обновления может не быть
+    for (const ReportDefinition &report : Reports::all(dialect)) {
+        QString error;
+        if (!statements.prepare(db, report.name, report.sql, &error)) {
+            qDebug() << "Prepare error:" << report.name << error;
+        }
+    }
+}
+
+void QueryWorker::close()
+{
+    interrupter->detach();
+    statements.clear();
+    connections->release();
+}
+
+void QueryWorker::adviseIndexes()
+{
+    // Советник разбирает планы SQLite; индексы сервера ведёт его администратор
+    if (dialect != SqlDialect::Sqlite) {
+        emit indexAdviceReady(IndexAdvice());
+        return;
+    }
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    emit indexAdviceReady(IndexAdvisor::analyze(db));
+}
+
+void QueryWorker::createIndexes(const QStringList &statements)
+{
+    if (dialect != SqlDialect::Sqlite) {
+        emit indexesCreated(QStringList() << "index advisor is available for SQLite only");
+        return;
+    }
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    emit indexesCreated(IndexAdvisor::apply(db, statements));
+}
+
+void QueryWorker::loadCube()
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    // Версия читается до загрузки: изменения во время загрузки
+    // приведут к ещё одной перезагрузке, а не потеряются
+    cubeVersion = dataVersion(db);
+    // Кубы — самые большие результаты: на PostgreSQL они читаются через
+    // курсор, и в памяти клиента нет всего результата сразу
+    int fetchSize = connections->config().fetchSize;
+    QSharedPointer<SalesCube> cube(new SalesCube);
+    QString error;
+    if (!cube->load(db, fetchSize, &error)) {
+        emit errorOccurred(error);
+        return;
+    }
+    emit cubeReady(cube);
+
+    QSharedPointer<TimeCube> timeCube(new TimeCube);
+    if (!timeCube->load(db, fetchSize, &error)) {
+        emit errorOccurred(error);
+        return;
+    }
+    emit timeCubeReady(timeCube);
+}
+
+void QueryWorker::checkCube()
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    checkCubeVersion(dataVersion(db));
+}
+
+void QueryWorker::checkCubeVersion(const DataVersion &version)
+{
+    if (!cubeVersion.isValid() || version == cubeVersion) {
+        return;
+    }
+    // Перезагрузка ставится в очередь после текущего запроса; до её
+    // начала повторные проверки ничего не делают
+    cubeVersion = DataVersion();
+    QMetaObject::invokeMethod(this, &QueryWorker::loadCube, Qt::QueuedConnection);
+}
+
+DataVersion QueryWorker::dataVersion(const QSqlDatabase &db) const
+{
+    // Оба запроса дешёвые: прагма не читает страниц, MAX по первичному ключу.
+    // В PostgreSQL прагмы нет, её заменяет счётчик изменённых строк из
+    // статистики; он отстаёт от чужих транзакций примерно на секунду
+    DataVersion version;
+    QSqlQuery query(db);
+    QString versionSql = dialect == SqlDialect::Postgres
+        ? "SELECT COALESCE(SUM(n_tup_ins + n_tup_upd + n_tup_del), 0) FROM pg_stat_user_tables"
+        : "PRAGMA data_version";
+    if (query.exec(versionSql) && query.next()) {
+        version.dataVersion = query.value(0).toLongLong();
+    }
+    if (query.exec("SELECT MAX(InvoiceId) FROM invoices") && query.next()) {
+        version.maxInvoiceId = query.value(0).toLongLong();
+    }
+    return version;
+}
+
+void QueryWorker::execute(quint64 id, const QueryRequest &request, const CancelFlag &cancel)
+{
+    TRACE_SCOPE_CATEGORY("worker", "query");
+    QueryResult result;
+
+    // Запрос мог устареть, пока ждал в очереди
+    if (cancel->load()) {
+        result.cancelled = true;
+        emit finished(id, result);
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+
+    // Колоночный движок сам следит за версией данных и перезагружается
+    // при изменениях, поэтому его результаты не кэшируются
+    ReportId report;
+    bool isReport = Reports::findByName(request.report, &report);
+    bool known = isReport && request.params.isEmpty();
+    bool local = dialect == SqlDialect::Sqlite;
+    if (local && known && engine == ExecutionEngine::Columnar && columnar.supports(report)
+            && columnar.ensureLoaded(db, dataVersion(db))) {
+        TRACE_SCOPE_CATEGORY("columnar", "query");
+        result = columnar.run(report);
+        emit finished(id, result);
+        return;
+    }
+
+    // Скетчи досчитываются по новым счетам и не кэшируются. Точный режим
+    // идёт обычным путём и служит для проверки приближённого
+    if (local && known && report == ReportId::ArtistsByGenre && request.topPerGroup > 0 && approximateTopK) {
+        TRACE_SCOPE_CATEGORY("topk", "query");
+        QString error;
+        if (artistTopK.update(db, dataVersion(db), &error)) {
+            result = artistTopK.run(request.topPerGroup);
+        } else {
+            result.error = error;
+        }
+        emit finished(id, result);
+        return;
+    }
+
+    // Параллельный режим сканирует исходные таблицы, а не агрегаты
+    bool parallel = local && known && engine == ExecutionEngine::Partitioned && partitioned.supports(report);
+
+    // Агрегаты досчитываются до проверки кэша. Фильтры по параметрам
+    // агрегаты не поддерживают, такие запросы идут по исходным таблицам.
+    // SQL отчёта в запросе написан для SQLite, для другой СУБД берётся свой
+    QString sql = isReport && !local ? Reports::definition(report, dialect).sql : request.sql;
+    QString statementName = request.report;
+    const QVariantMap &params = request.params;
+    if (local && !parallel && !request.rollupSql.isEmpty() && params.isEmpty() && rollup.refresh(db)) {
+        sql = request.rollupSql;
+        statementName = request.report + "/rollup";
+    }
+
+    DataVersion version = dataVersion(db);
+    cache.validate(version);
+    checkCubeVersion(version);
+    QString key = ReportCache::makeKey(parallel ? "partitioned:" + request.report : sql, params);
+    bool cached = cache.lookup(key, &result);
+    emit cacheStatsChanged(cache.hits(), cache.misses());
+    if (cached) {
+        result.fromCache = true;
+        emit finished(id, result);
+        return;
+    }
+
+    if (parallel) {
+        TRACE_SCOPE_CATEGORY("partitioned", "query");
+        result = partitioned.run(db, report, *cancel);
+        cache.insert(key, result);
+        emit finished(id, result);
+        return;
+    }
+
+    // Прерывать можно только сам отчёт: обслуживание агрегатов, проверка
+    // версии и загрузка движков выше не должны откатываться на полпути.
+    // Охрана объявлена до запроса, чтобы он завершился раньше неё
+    QueryInterrupt::Running running(*interrupter, id);
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    bool ok;
+    {
+        TRACE_SCOPE_CATEGORY("exec", "query");
+        if (isReport && statements.prepare(db, statementName, sql)) {
+            ok = statements.exec(statementName, params, Reports::defaultParams(), &query);
+        } else if (params.isEmpty()) {
+            ok = query.exec(sql);
+        } else {
+            ok = query.prepare(sql);
+            for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+                query.bindValue(it.key(), it.value());
+            }
+            ok = ok && query.exec();
+        }
+    }
+    if (!ok) {
+        // Ошибка прерванного запроса — это отмена
+        if (cancel->load()) {
+            result.cancelled = true;
+        } else {
+            result.error = query.lastError().text();
+        }
+        emit finished(id, result);
+        return;
+    }
+
+    QSqlRecord record = query.record();
+    int columnCount = record.count();
+    for (int col = 0; col < columnCount; ++col) {
+        result.columns << record.fieldName(col);
+    }
+    result.data.resize(columnCount);
+
+    // Значения сразу раскладываются по столбцам, без промежуточных строк
+    {
+        TRACE_SCOPE_CATEGORY("fetch", "query");
+        while (query.next()) {
+            // Проверяем отмену на каждой строке, чтобы не дочитывать устаревший отчёт
+            if (cancel->load()) {
+                result.cancelled = true;
+                break;
+            }
+            for (int col = 0; col < columnCount; ++col) {
+                result.data[col].append(query.value(col));
+            }
+        }
+        // Прерванный при отмене запрос заканчивает выборку раньше времени
+        if (cancel->load()) {
+            result.cancelled = true;
+        } else if (query.lastError().isValid()) {
+            result.error = query.lastError().text();
+        }
+        // Подготовленный запрос остаётся в реестре, но его курсор сбрасывается
+        query.finish();
+    }
+    Tracing::counter("rows", result.rowCount());
+
+    cache.insert(key, result);
+    emit finished(id, result);
+}
+
+QueryExecutor::QueryExecutor(const StorageConfig &storage, QObject *parent)
+    : QObject(parent)
+    , interrupter(new QueryInterrupt)
+    , worker(new QueryWorker(ConnectionPoolPtr(new ConnectionPool(storage)), interrupter))
+    , nextId(0)
+    , hits(0)
+    , misses(0)
+{
+    qRegisterMetaType<QueryResult>();
+    qRegisterMetaType<IndexAdvice>();
+    qRegisterMetaType<SalesCubePtr>();
+    qRegisterMetaType<TimeCubePtr>();
+
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::started, worker, &QueryWorker::open);
+    connect(&workerThread, &QThread::finished, worker, &QueryWorker::close);
+    connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &QueryWorker::finished, this, &QueryExecutor::onFinished);
+    connect(worker, &QueryWorker::errorOccurred, this, &QueryExecutor::errorOccurred);
+    connect(worker, &QueryWorker::indexAdviceReady, this, &QueryExecutor::indexAdviceReady);
+    connect(worker, &QueryWorker::indexesCreated, this, &QueryExecutor::indexesCreated);
+    connect(worker, &QueryWorker::cubeReady, this, &QueryExecutor::cubeReady);
+    connect(worker, &QueryWorker::timeCubeReady, this, &QueryExecutor::timeCubeReady);
+    connect(worker, &QueryWorker::cacheStatsChanged, this, [this](quint64 cacheHits, quint64 cacheMisses) {
+        hits = cacheHits;
+        misses = cacheMisses;
+        emit cacheStatsChanged(hits, misses);
+    });
+
+    workerThread.start();
+}
+
+QueryExecutor::~QueryExecutor()
+{
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        it->cancel->store(1);
+        interrupter->interrupt(it.key());
+    }
+    workerThread.quit();
+    workerThread.wait();
+}
+
+quint64 QueryExecutor::submit(const QString &channel, const QString &sql, Handler handler)
+{
+    return submit(channel, sql, QVariantMap(), handler);
+}
+
+quint64 QueryExecutor::submit(const QString &channel, const QString &sql, const QVariantMap &params, Handler handler)
+{
+    QueryRequest request;
+    request.sql = sql;
+    request.params = params;
+    return submit(channel, request, handler);
+}
+
+quint64 QueryExecutor::submit(const QString &channel, const QueryRequest &request, Handler handler)
+{
+    cancel(channel);
+
+    bool wasBusy = isBusy();
+    quint64 id = ++nextId;
+    CancelFlag flag(new QAtomicInt(0));
+    pending.insert(id, Pending{channel, flag, handler});
+    latest.insert(channel, id);
+
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target, id, request, flag]() {
+        target->execute(id, request, flag);
+    }, Qt::QueuedConnection);
+
+    if (!wasBusy) {
+        emit busyChanged(true);
+    }
+    return id;
+}
+
+void QueryExecutor::setEngine(ExecutionEngine engine)
+{
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target, engine]() {
+        target->setEngine(engine);
+    }, Qt::QueuedConnection);
+}
+
+void QueryExecutor::setApproximateTopK(bool approximate)
+{
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target, approximate]() {
+        target->setApproximateTopK(approximate);
+    }, Qt::QueuedConnection);
+}
+
+void QueryExecutor::adviseIndexes()
+{
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target]() {
+        target->adviseIndexes();
+    }, Qt::QueuedConnection);
+}
+
+void QueryExecutor::createIndexes(const QStringList &statements)
+{
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target, statements]() {
+        target->createIndexes(statements);
+    }, Qt::QueuedConnection);
+}
+
+void QueryExecutor::loadCube()
+{
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target]() {
+        target->loadCube();
+    }, Qt::QueuedConnection);
+}
+
+void QueryExecutor::checkCube()
+{
+    QueryWorker *target = worker;
+    QMetaObject::invokeMethod(worker, [target]() {
+        target->checkCube();
+    }, Qt::QueuedConnection);
+}
+
+void QueryExecutor::cancel(const QString &channel)
+{
+    auto it = latest.find(channel);
+    if (it == latest.end()) {
+        return;
+    }
+    auto request = pending.find(it.value());
+    if (request != pending.end()) {
+        request->cancel->store(1);
+        // Выполняющийся запрос прерывается сразу, а не на следующей строке
+        interrupter->interrupt(it.value());
+    }
+    latest.erase(it);
+}
+
+void QueryExecutor::onFinished(quint64 id, const QueryResult &result)
+{
+    if (!pending.contains(id)) {
+        return;
+    }
+    Pending request = pending.take(id);
+    if (latest.value(request.channel) == id) {
+        latest.remove(request.channel);
+    }
+
+    // Результаты отменённых запросов просто отбрасываются
+    if (!result.cancelled && !request.cancel->load()) {
+        if (!result.error.isEmpty()) {
+            qDebug() << "Query error:" << result.error;
+            emit errorOccurred(result.error);
+        } else if (request.handler) {
+            request.handler(result);
+        }
+    }
+
+    if (pending.isEmpty()) {
+        emit busyChanged(false);
+    }
+}
@@ -0,0 +1,164 @@
+#ifndef QUERYEXECUTOR_H
+#define QUERYEXECUTOR_H
+
+#include "artisttopk.h"
+#include "columnarengine.h"
+#include "indexadvisor.h"
+#include "partitionedaggregator.h"
+#include "queryinterrupt.h"
+#include "queryresult.h"
+#include "reportcache.h"
+#include "salescube.h"
+#include "salesrollup.h"
+#include "statementregistry.h"
+#include "storageconfig.h"
+#include "timecube.h"
+#include <QAtomicInt>
+#include <QHash>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVariantMap>
+#include <functional>
+
+// Флаг отмены, разделяемый GUI-потоком и рабочим потоком
+typedef QSharedPointer<QAtomicInt> CancelFlag;
+
+// Запрос отчёта. rollupSql, если задан, даёт тот же результат по
+// материализованным агрегатам и используется, пока они доступны.
+// report — имя отчёта для движков, которые считают его без SQL.
+// topPerGroup > 0 — нужны только первые строки в каждой группе, и при
+// включённом приближённом топе их можно взять из скетчей
+struct QueryRequest
+{
+    QString report;
+    QString sql;
+    QString rollupSql;
+    QVariantMap params;
+    int topPerGroup = 0;
+};
+
+// Чем считаются отчёты без параметров: SQL по базе, колоночный движок
+// в памяти или SQL по диапазонам счетов на всех ядрах. Отчёты, которые
+// движок не поддерживает, идут обычным SQL
+enum class ExecutionEngine { Sql, Columnar, Partitioned };
+
+// Выполняет запросы в рабочем потоке через соединение пула этого потока.
+// Движки в памяти, скетчи и агрегаты rollup_* держат копию данных у
+// клиента и работают только с SQLite; PostgreSQL считает отчёты сам
+class QueryWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    QueryWorker(const ConnectionPoolPtr &connections, const QueryInterruptPtr &interrupter);
+
+    void execute(quint64 id, const QueryRequest &request, const CancelFlag &cancel);
+    void setEngine(ExecutionEngine value) { engine = value; }
+    void setApproximateTopK(bool value) { approximateTopK = value; }
+
+public slots:
+    void open();
+    void close();
+    void adviseIndexes();
+    void createIndexes(const QStringList &statements);
+    void loadCube();
+    void checkCube();
+
+signals:
+    void finished(quint64 id, const QueryResult &result);
+    void errorOccurred(const QString &message);
+    void cacheStatsChanged(quint64 hits, quint64 misses);
+    void indexAdviceReady(const IndexAdvice &advice);
+    void indexesCreated(const QStringList &log);
+    void cubeReady(const SalesCubePtr &cube);
+    void timeCubeReady(const TimeCubePtr &cube);
+
+private:
+    DataVersion dataVersion(const QSqlDatabase &db) const;
+    void checkCubeVersion(const DataVersion &version);
+
+    ConnectionPoolPtr connections;
+    QueryInterruptPtr interrupter;
+    SqlDialect dialect;
+    QString connectionName;
+    ReportCache cache;
+    SalesRollup rollup;
+    StatementRegistry statements;
+    ExecutionEngine engine;
+    ColumnarEngine columnar;
+    PartitionedAggregator partitioned;
+    bool approximateTopK;
+    ArtistTopK artistTopK;
+    DataVersion cubeVersion; // версия данных загруженных кубов
+};
+
+// Асинхронный исполнитель запросов отчётов. Результаты доставляются
+// в GUI-поток; новый запрос в том же канале отменяет незавершённый старый
+class QueryExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(const QueryResult &)> Handler;
+
+    explicit QueryExecutor(const StorageConfig &storage, QObject *parent = nullptr);
+    ~QueryExecutor() override;
+
+    quint64 submit(const QString &channel, const QString &sql, Handler handler);
+    quint64 submit(const QString &channel, const QString &sql, const QVariantMap &params, Handler handler);
+    quint64 submit(const QString &channel, const QueryRequest &request, Handler handler);
+    void cancel(const QString &channel);
+    bool isBusy() const { return !pending.isEmpty(); }
+
+    void setEngine(ExecutionEngine engine);
+    // Топ артистов по жанрам по скетчам частых элементов или точным SQL
+    void setApproximateTopK(bool approximate);
+
+    // Анализ планов отчётов и создание предложенных индексов; выполняются
+    // в рабочем потоке в общей очереди с отчётами
+    void adviseIndexes();
+    void createIndexes(const QStringList &statements);
+
+    // Загрузка куба продаж для перекрёстных фильтров и временного куба.
+    // Готовые кубы только читаются, поэтому передаются в GUI-поток целиком
+    void loadCube();
+    // Кубы перезагружаются, если данные изменились после их загрузки;
+    // новые кубы приходят теми же сигналами
+    void checkCube();
+
+    quint64 cacheHits() const { return hits; }
+    quint64 cacheMisses() const { return misses; }
+
+signals:
+    void busyChanged(bool busy);
+    void errorOccurred(const QString &message);
+    void cacheStatsChanged(quint64 hits, quint64 misses);
+    void indexAdviceReady(const IndexAdvice &advice);
+    void indexesCreated(const QStringList &log);
+    void cubeReady(const SalesCubePtr &cube);
+    void timeCubeReady(const TimeCubePtr &cube);
+
+private slots:
+    void onFinished(quint64 id, const QueryResult &result);
+
+private:
+    struct Pending
+    {
+        QString channel;
+        CancelFlag cancel;
+        Handler handler;
+    };
+
+    QueryInterruptPtr interrupter; // прерывает запрос рабочего потока при отмене
+    QThread workerThread;
+    QueryWorker *worker;
+    quint64 nextId;
+    QHash<quint64, Pending> pending;  // id запроса -> ожидающий обработчик
+    QHash<QString, quint64> latest;   // канал -> id последнего запроса
+    quint64 hits;
+    quint64 misses;
+};
+
+#endif // QUERYEXECUTOR_H
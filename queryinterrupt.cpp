@@ -0,0 +1,93 @@
+#include "queryinterrupt.h"
+#include <QMutexLocker>
+#include <QSqlDriver>
+#include <QVariant>
+#include <QDebug>
+#ifdef HAVE_SQLITE_INTERRUPT
+#include <sqlite3.h>
+#endif
+#ifdef HAVE_PQ_CANCEL
+#include <libpq-fe.h>
+#endif
+
+QueryInterrupt::QueryInterrupt()
+    : sqliteHandle(nullptr)
+    , pgCancel(nullptr)
+    , running(0)
+{
+}
+
+QueryInterrupt::~QueryInterrupt()
+{
+    detach();
+}
+
+void QueryInterrupt::attach(const QSqlDatabase &db)
+{
+    detach();
+    QVariant handle = db.driver() ? db.driver()->handle() : QVariant();
+    if (!handle.isValid()) {
+        return;
+    }
+
+    // Дескриптор драйвера — указатель на структуру библиотеки СУБД
+    QMutexLocker locker(&mutex);
+#ifdef HAVE_SQLITE_INTERRUPT
+    if (qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        sqliteHandle = *static_cast<sqlite3 *const *>(handle.constData());
+    }
+#endif
+#ifdef HAVE_PQ_CANCEL
+    if (qstrcmp(handle.typeName(), "PGconn*") == 0) {
+        PGconn *connection = *static_cast<PGconn *const *>(handle.constData());
+        pgCancel = connection ? PQgetCancel(connection) : nullptr;
+    }
+#endif
+}
+
+void QueryInterrupt::detach()
+{
+    QMutexLocker locker(&mutex);
+#ifdef HAVE_PQ_CANCEL
+    if (pgCancel) {
+        PQfreeCancel(static_cast<PGcancel *>(pgCancel));
+    }
+#endif
+    sqliteHandle = nullptr;
+    pgCancel = nullptr;
+    running = 0;
+}
+
+void QueryInterrupt::begin(quint64 id)
+{
+    QMutexLocker locker(&mutex);
+    running = id;
+}
+
+void QueryInterrupt::end()
+{
+    // После снятия отметки прерывание не может попасть в следующий запрос
+    QMutexLocker locker(&mutex);
+    running = 0;
+}
+
+void QueryInterrupt::interrupt(quint64 id)
+{
+    QMutexLocker locker(&mutex);
+    if (running == 0 || running != id) {
+        return;
+    }
+#ifdef HAVE_SQLITE_INTERRUPT
+    if (sqliteHandle) {
+        sqlite3_interrupt(static_cast<sqlite3 *>(sqliteHandle));
+    }
+#endif
+#ifdef HAVE_PQ_CANCEL
+    if (pgCancel) {
+        char message[256];
+        if (!PQcancel(static_cast<PGcancel *>(pgCancel), message, sizeof(message))) {
+            qDebug() << "PQcancel failed:" << message;
+        }
+    }
+#endif
+}
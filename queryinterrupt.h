@@ -0,0 +1,51 @@
+#ifndef QUERYINTERRUPT_H
+#define QUERYINTERRUPT_H
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+
+// Прерывание выполняющегося запроса из другого потока. Для SQLite это
+// sqlite3_interrupt по дескриптору соединения драйвера, для PostgreSQL —
+// PQcancel (запрос отмены серверу по отдельному соединению). Обе функции
+// есть только в сборке с CONFIG+=sqlite_interrupt и CONFIG+=pq_cancel;
+// без них отмена срабатывает между строками результата.
+// Прерывается только запрос, отмеченный как выполняющийся: отмена
+// запроса из очереди не задевает текущий
+class QueryInterrupt
+{
+public:
+    QueryInterrupt();
+    ~QueryInterrupt();
+
+    // В потоке соединения: после открытия и перед закрытием
+    void attach(const QSqlDatabase &db);
+    void detach();
+
+    // Пока жив объект, на соединении выполняется запрос id
+    class Running
+    {
+    public:
+        Running(QueryInterrupt &target, quint64 id) : target(target) { target.begin(id); }
+        ~Running() { target.end(); }
+
+    private:
+        QueryInterrupt &target;
+    };
+
+    // Из любого потока; если id уже не выполняется, ничего не делает
+    void interrupt(quint64 id);
+
+private:
+    void begin(quint64 id);
+    void end();
+
+    QMutex mutex;
+    void *sqliteHandle; // sqlite3*
+    void *pgCancel;     // PGcancel*
+    quint64 running;    // 0 — соединение свободно
+};
+
+typedef QSharedPointer<QueryInterrupt> QueryInterruptPtr;
+
+#endif // QUERYINTERRUPT_H
@@ -0,0 +1,192 @@
+#include "queryresult.h"
+
+namespace
+{
+
+ResultColumn::Type typeOf(const QVariant &value)
+{
+    switch (value.type()) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return ResultColumn::Integer;
+    case QVariant::Double:
+        return ResultColumn::Real;
+    default:
+        return ResultColumn::Text;
+    }
+}
+
+} // namespace
+
+ResultColumn::ResultColumn()
+    : columnType(Null)
+    , count(0)
+{
+}
+
+void ResultColumn::reserve(int rows)
+{
+    switch (columnType) {
+    case Integer: integers.reserve(rows); break;
+    case Real: reals.reserve(rows); break;
+    case Text: codes.reserve(rows); break;
+    case Null: break;
+    }
+}
+
+void ResultColumn::append(const QVariant &value)
+{
+    if (value.isNull()) {
+        if (nulls.size() <= count) {
+            nulls.resize(qMax(64, (count + 1) * 2));
+        }
+        nulls.setBit(count);
+        switch (columnType) {
+        case Integer: integers.append(0); break;
+        case Real: reals.append(0.0); break;
+        case Text: codes.append(-1); break;
+        case Null: break;
+        }
+        ++count;
+        return;
+    }
+
+    // SQLite типизирует значения, а не столбцы: при смешанных типах
+    // столбец расширяется до вещественного или текстового
+    Type valueType = typeOf(value);
+    if (columnType == Null
+            || (columnType == Integer && valueType != Integer)
+            || (columnType == Real && valueType == Text)) {
+        promoteTo(valueType);
+    }
+
+    switch (columnType) {
+    case Integer:
+        integers.append(value.toLongLong());
+        break;
+    case Real:
+        reals.append(value.toDouble());
+        break;
+    case Text: {
+        QString text = value.toString();
+        qint32 code = lookup.value(text, -1);
+        if (code < 0) {
+            code = dictionary.size();
+            dictionary.append(text);
+            lookup.insert(text, code);
+        }
+        codes.append(code);
+        break;
+    }
+    case Null:
+        break;
+    }
+    ++count;
+}
+
+void ResultColumn::promoteTo(Type type)
+{
+    if (type == columnType) {
+        return;
+    }
+
+    if (type == Text) {
+        // Уже накопленные числа переводятся в строки один раз
+        QVector<qint32> textCodes;
+        textCodes.reserve(count);
+        for (int row = 0; row < count; ++row) {
+            if (isNull(row) || columnType == Null) {
+                textCodes.append(-1);
+                continue;
+            }
+            QString text = value(row).toString();
+            qint32 code = lookup.value(text, -1);
+            if (code < 0) {
+                code = dictionary.size();
+                dictionary.append(text);
+                lookup.insert(text, code);
+            }
+            textCodes.append(code);
+        }
+        codes = textCodes;
+    } else if (type == Real) {
+        reals.resize(count);
+        if (columnType == Integer) {
+            for (int row = 0; row < count; ++row) {
+                reals[row] = double(integers[row]);
+            }
+        }
+    } else if (type == Integer) {
+        integers.resize(count);
+    }
+
+    integers = (type == Integer) ? integers : QVector<qint64>();
+    reals = (type == Real) ? reals : QVector<double>();
+    columnType = type;
+}
+
+QVariant ResultColumn::value(int row) const
+{
+    if (isNull(row)) {
+        return QVariant();
+    }
+    switch (columnType) {
+    case Integer: return QVariant(integers.at(row));
+    case Real: return QVariant(reals.at(row));
+    case Text: return QVariant(textAt(row));
+    case Null: break;
+    }
+    return QVariant();
+}
+
+qint64 ResultColumn::integerAt(int row) const
+{
+    switch (columnType) {
+    case Integer: return integers.at(row);
+    case Real: return qint64(reals.at(row));
+    case Text: return textAt(row).toLongLong();
+    case Null: break;
+    }
+    return 0;
+}
+
+double ResultColumn::realAt(int row) const
+{
+    switch (columnType) {
+    case Integer: return double(integers.at(row));
+    case Real: return reals.at(row);
+    case Text: return textAt(row).toDouble();
+    case Null: break;
+    }
+    return 0.0;
+}
+
+QString ResultColumn::textAt(int row) const
+{
+    if (columnType != Text) {
+        return value(row).toString();
+    }
+    qint32 code = codes.at(row);
+    return code < 0 ? QString() : dictionary.at(code);
+}
+
+QVariant QueryResult::value(int row, int column) const
+{
+    if (column < 0 || column >= data.size()) {
+        return QVariant();
+    }
+    return data.at(column).value(row);
+}
+
+void QueryResult::appendRow(const QVector<QVariant> &values)
+{
+    if (data.size() < columns.size()) {
+        data.resize(columns.size());
+    }
+    for (int col = 0; col < data.size(); ++col) {
+        data[col].append(values.value(col));
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef QUERYRESULT_H
+#define QUERYRESULT_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QMetaType>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+// Столбец результата. Числа хранятся в непрерывных массивах, строки —
+// словарём с целочисленными кодами, поэтому ячейка стоит несколько байт
+// вместо QVariant с отдельным QString
+class ResultColumn
+{
+public:
+    enum Type { Null, Integer, Real, Text };
+
+    ResultColumn();
+
+    Type type() const { return columnType; }
+    int size() const { return count; }
+
+    void append(const QVariant &value);
+    void reserve(int rows);
+
+    bool isNull(int row) const { return row < nulls.size() && nulls.testBit(row); }
+    QVariant value(int row) const;
+    qint64 integerAt(int row) const;
+    double realAt(int row) const;
+    QString textAt(int row) const;
+
+private:
+    void promoteTo(Type type);
+
+    Type columnType;
+    int count;
+    QVector<qint64> integers;
+    QVector<double> reals;
+    QVector<qint32> codes;
+    QStringList dictionary;
+    QHash<QString, qint32> lookup;
+    QBitArray nulls;
+};
+
+// Результат запроса, полностью выбранный в рабочем потоке и
+// хранящийся по столбцам
+struct QueryResult
+{
+    QStringList columns;
+    QVector<ResultColumn> data;
+    QString error;
+    bool cancelled = false;
+    bool fromCache = false;
+
+    int rowCount() const { return data.isEmpty() ? 0 : data.first().size(); }
+    int columnCount() const { return columns.size(); }
+    int columnIndex(const QString &name) const { return columns.indexOf(name); }
+
+    const ResultColumn &column(int column) const { return data.at(column); }
+    QVariant value(int row, int column) const;
+    QVariant value(int row, const QString &column) const { return value(row, columnIndex(column)); }
+
+    void appendRow(const QVector<QVariant> &values);
+};
+
+Q_DECLARE_METATYPE(QueryResult)
+
+#endif // QUERYRESULT_H
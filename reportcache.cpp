@@ -0,0 +1,88 @@
+#include "reportcache.h"
+
+ReportCache::ReportCache(int maxRows)
+    : entries(maxRows)
+    , hitCount(0)
+    , missCount(0)
+    , invalidationCount(0)
+{
+}
+
+QString ReportCache::normalizeSql(const QString &sql)
+{
+    // Схлопываем пробельные символы вне строковых литералов и убираем
+    // завершающую точку с запятой, чтобы форматирование не влияло на ключ
+    QString normalized;
+    normalized.reserve(sql.size());
+    bool inLiteral = false;
+    bool pendingSpace = false;
+    for (QChar ch : sql) {
+        if (ch == '\'') {
+            inLiteral = !inLiteral;
+        }
+        if (!inLiteral && ch.isSpace()) {
+            pendingSpace = !normalized.isEmpty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized += ' ';
+            pendingSpace = false;
+        }
+        normalized += ch;
+    }
+    while (normalized.endsWith(';') || normalized.endsWith(' ')) {
+        normalized.chop(1);
+    }
+    return normalized;
+}
+
+QString ReportCache::makeKey(const QString &sql, const QVariantMap &params)
+{
+    QString key = normalizeSql(sql);
+    // QVariantMap упорядочен по имени, поэтому порядок привязки не важен
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        key += QString("\x1f%1=%2:%3").arg(it.key(), it.value().typeName(), it.value().toString());
+    }
+    return key;
+}
+
+bool ReportCache::validate(const DataVersion &current)
+{
+    if (current.isValid() && current == version) {
+        return false;
+    }
+    bool invalidated = entries.size() > 0;
+    if (invalidated) {
+        ++invalidationCount;
+    }
+    entries.clear();
+    version = current;
+    return invalidated;
+}
+
+bool ReportCache::lookup(const QString &key, QueryResult *result)
+{
+    QueryResult *cached = entries.object(key);
+    if (!cached) {
+        ++missCount;
+        return false;
+    }
+    ++hitCount;
+    *result = *cached;
+    return true;
+}
+
+void ReportCache::insert(const QString &key, const QueryResult &result)
+{
+    // Отменённые и ошибочные результаты не кэшируются
+    if (result.cancelled || !result.error.isEmpty() || !version.isValid()) {
+        return;
+    }
+    entries.insert(key, new QueryResult(result), result.rowCount() + 1);
+}
+
+void ReportCache::clear()
+{
+    entries.clear();
+    version = DataVersion();
+}
@@ -0,0 +1,51 @@
+#ifndef REPORTCACHE_H
+#define REPORTCACHE_H
+
+#include "queryresult.h"
+#include <QCache>
+#include <QVariantMap>
+
+// Версия данных БД: PRAGMA data_version меняется при коммитах других
+// соединений, максимальный InvoiceId — при появлении новых счетов
+struct DataVersion
+{
+    qint64 dataVersion = -1;
+    qint64 maxInvoiceId = -1;
+
+    bool isValid() const { return dataVersion >= 0; }
+    bool operator==(const DataVersion &other) const
+    {
+        return dataVersion == other.dataVersion && maxInvoiceId == other.maxInvoiceId;
+    }
+    bool operator!=(const DataVersion &other) const { return !(*this == other); }
+};
+
+// Кэш результатов отчётов. Ключ — нормализованный SQL и параметры,
+// весь кэш сбрасывается при смене версии данных
+class ReportCache
+{
+public:
+    explicit ReportCache(int maxRows = 500000);
+
+    static QString normalizeSql(const QString &sql);
+    static QString makeKey(const QString &sql, const QVariantMap &params);
+
+    // Возвращает true, если кэш был сброшен из-за изменения данных
+    bool validate(const DataVersion &version);
+    bool lookup(const QString &key, QueryResult *result);
+    void insert(const QString &key, const QueryResult &result);
+    void clear();
+
+    quint64 hits() const { return hitCount; }
+    quint64 misses() const { return missCount; }
+    quint64 invalidations() const { return invalidationCount; }
+
+private:
+    QCache<QString, QueryResult> entries;
+    DataVersion version;
+    quint64 hitCount;
+    quint64 missCount;
+    quint64 invalidationCount;
+};
+
+#endif // REPORTCACHE_H
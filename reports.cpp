@@ -0,0 +1,353 @@
+#include "reports.h"
+#include <QMap>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Псевдонимы в кавычках: PostgreSQL иначе вернёт имена столбцов в нижнем
+// регистре. Агрегаты rollup_* ведутся только в файле SQLite.
+// Фильтр «(:x IS NULL OR столбец = :x)» не теряет строк с NULL в столбце;
+// CAST задаёт PostgreSQL тип параметра, который иначе не выводится из IS NULL
+QList<ReportDefinition> buildDefinitions(SqlDialect dialect)
+{
+    QList<ReportDefinition> definitions;
+    bool sqlite = dialect == SqlDialect::Sqlite;
+
+    definitions.append({ReportId::MonthlySales, "monthly-sales", QString(R"(
+        SELECT %1 AS "Month", SUM(invoice_items.Quantity) AS "TotalSales"
+        FROM invoice_items
+        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+        WHERE invoices.InvoiceDate >= :dateFrom AND invoices.InvoiceDate < :dateTo
+          AND (CAST(:country AS TEXT) IS NULL OR invoices.BillingCountry = :country)
+          AND (CAST(:genreId AS INTEGER) IS NULL
+               OR invoice_items.TrackId IN (SELECT TrackId FROM tracks WHERE GenreId = :genreId))
+        GROUP BY 1
+        ORDER BY 1;
+    )").arg(Dialect::monthOf(dialect, "invoices.InvoiceDate")), !sqlite ? QString() : R"(
+        SELECT Month, Quantity AS TotalSales
+        FROM rollup_monthly_sales
+        ORDER BY Month;
+    )"});
+
+    definitions.append({ReportId::RevenueByGenre, "revenue-by-genre", R"(
+        SELECT genres.Name AS "GenreName",
+               ROUND(CAST(SUM(invoice_items.Quantity * invoice_items.UnitPrice) AS NUMERIC), 2) AS "Revenue"
+        FROM invoice_items
+        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+        JOIN genres ON tracks.GenreId = genres.GenreId
+        WHERE invoices.InvoiceDate >= :dateFrom AND invoices.InvoiceDate < :dateTo
+          AND (CAST(:country AS TEXT) IS NULL OR invoices.BillingCountry = :country)
+          AND (CAST(:genreId AS INTEGER) IS NULL OR tracks.GenreId = :genreId)
+        GROUP BY genres.GenreId, genres.Name
+        ORDER BY "Revenue" DESC;
+    )", !sqlite ? QString() : R"(
+        SELECT genres.Name AS GenreName, ROUND(rollup_genre_sales.Revenue, 2) AS Revenue
+        FROM rollup_genre_sales
+        JOIN genres ON rollup_genre_sales.GenreId = genres.GenreId
+        ORDER BY Revenue DESC;
+    )"});
+
+    // Все пары (жанр, артист): таблице нужны первые три ранга, диаграмме — три первых строки
+    definitions.append({ReportId::ArtistsByGenre, "artists-by-genre", R"(
+        SELECT genres.Name AS "GenreName", artists.Name AS "ArtistName", SUM(invoice_items.Quantity) AS "TotalSales"
+        FROM invoice_items
+        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+        JOIN albums ON tracks.AlbumId = albums.AlbumId
+        JOIN artists ON albums.ArtistId = artists.ArtistId
+        JOIN genres ON tracks.GenreId = genres.GenreId
+        WHERE invoices.InvoiceDate >= :dateFrom AND invoices.InvoiceDate < :dateTo
+          AND (CAST(:country AS TEXT) IS NULL OR invoices.BillingCountry = :country)
+          AND (CAST(:genreId AS INTEGER) IS NULL OR tracks.GenreId = :genreId)
+        GROUP BY genres.GenreId, genres.Name, artists.ArtistId, artists.Name
+        ORDER BY "GenreName", "TotalSales" DESC;
+    )"});
+
+    definitions.append({ReportId::TopArtists, "top-artists", R"(
+        SELECT artists.Name AS "ArtistName", SUM(invoice_items.Quantity) AS "TotalQuantity",
+               ROUND(CAST(SUM(invoice_items.UnitPrice * invoice_items.Quantity) AS NUMERIC), 2) AS "TotalSales"
+        FROM invoice_items
+        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+        JOIN albums ON tracks.AlbumId = albums.AlbumId
+        JOIN artists ON albums.ArtistId = artists.ArtistId
+        WHERE invoices.InvoiceDate >= :dateFrom AND invoices.InvoiceDate < :dateTo
+          AND (CAST(:country AS TEXT) IS NULL OR invoices.BillingCountry = :country)
+          AND (CAST(:genreId AS INTEGER) IS NULL OR tracks.GenreId = :genreId)
+        GROUP BY artists.ArtistId, artists.Name
+        ORDER BY "TotalSales" DESC
+        LIMIT :limit;
+    )", !sqlite ? QString() : R"(
+        SELECT artists.Name AS ArtistName, rollup_artist_sales.Quantity AS TotalQuantity, ROUND(rollup_artist_sales.Revenue, 2) AS TotalSales
+        FROM rollup_artist_sales
+        JOIN artists ON rollup_artist_sales.ArtistId = artists.ArtistId
+        ORDER BY TotalSales DESC
+        LIMIT :limit;
+    )"});
+
+    // Страна x жанр: и количество (для карты), и выручка (для таблицы и диаграммы)
+    definitions.append({ReportId::SalesByCountryGenre, "sales-by-country-genre", R"(
+        SELECT invoices.BillingCountry AS "BillingCountry", genres.Name AS "GenreName",
+               SUM(invoice_items.Quantity) AS "TotalQuantity",
+               ROUND(CAST(SUM(invoice_items.Quantity * invoice_items.UnitPrice) AS NUMERIC), 2) AS "TotalSales"
+        FROM invoice_items
+        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+        JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+        JOIN genres ON tracks.GenreId = genres.GenreId
+        WHERE invoices.InvoiceDate >= :dateFrom AND invoices.InvoiceDate < :dateTo
+          AND (CAST(:country AS TEXT) IS NULL OR invoices.BillingCountry = :country)
+          AND (CAST(:genreId AS INTEGER) IS NULL OR tracks.GenreId = :genreId)
+        GROUP BY invoices.BillingCountry, genres.GenreId, genres.Name
+        ORDER BY "BillingCountry", "TotalQuantity" DESC, "GenreName";
+    )", !sqlite ? QString() : R"(
+        SELECT BillingCountry, genres.Name AS GenreName,
+               rollup_country_genre_sales.Quantity AS TotalQuantity,
+               ROUND(rollup_country_genre_sales.Revenue, 2) AS TotalSales
+        FROM rollup_country_genre_sales
+        JOIN genres ON rollup_country_genre_sales.GenreId = genres.GenreId
+        ORDER BY BillingCountry, TotalQuantity DESC, GenreName;
+    )"});
+
+    // Город x страна: точки карты, итоги стран — суммы по их городам
+    definitions.append({ReportId::SalesByCity, "sales-by-city", R"(
+        SELECT invoices.BillingCountry AS "BillingCountry", invoices.BillingCity AS "BillingCity",
+               SUM(invoice_items.Quantity) AS "TotalQuantity",
+               ROUND(CAST(SUM(invoice_items.Quantity * invoice_items.UnitPrice) AS NUMERIC), 2) AS "TotalSales"
+        FROM invoice_items
+        JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+        WHERE invoices.InvoiceDate >= :dateFrom AND invoices.InvoiceDate < :dateTo
+          AND (CAST(:country AS TEXT) IS NULL OR invoices.BillingCountry = :country)
+          AND (CAST(:genreId AS INTEGER) IS NULL
+               OR invoice_items.TrackId IN (SELECT TrackId FROM tracks WHERE GenreId = :genreId))
+        GROUP BY invoices.BillingCountry, invoices.BillingCity
+        ORDER BY "BillingCountry", "BillingCity";
+    )"});
+
+    return definitions;
+}
+
+} // namespace
+
+const ReportDefinition &Reports::definition(ReportId id, SqlDialect dialect)
+{
+    static const QList<ReportDefinition> sqliteDefinitions = buildDefinitions(SqlDialect::Sqlite);
+    static const QList<ReportDefinition> postgresDefinitions = buildDefinitions(SqlDialect::Postgres);
+    const QList<ReportDefinition> &definitions = dialect == SqlDialect::Postgres ? postgresDefinitions
+                                                                                 : sqliteDefinitions;
+    for (const ReportDefinition &report : definitions) {
+        if (report.id == id) {
+            return report;
+        }
+    }
+    Q_UNREACHABLE();
+    return definitions.first();
+}
+
+QVariantMap Reports::defaultParams()
+{
+    // NULL в фильтре страны или жанра означает «все»
+    QVariantMap params;
+    params.insert(":dateFrom", "0001-01-01"); // года 0 нет в типах дат PostgreSQL
+    params.insert(":dateTo", "9999-12-31");
+    params.insert(":country", QVariant(QVariant::String));
+    params.insert(":genreId", QVariant(QVariant::LongLong));
+    params.insert(":limit", 5);
+    return params;
+}
+
+QList<ReportDefinition> Reports::all(SqlDialect dialect)
+{
+    return buildDefinitions(dialect);
+}
+
+bool Reports::findByName(const QString &name, ReportId *id)
+{
+    for (const ReportDefinition &report : all()) {
+        if (report.name == name) {
+            *id = report.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+double Reports::roundToCents(double value)
+{
+    return std::round(value * 100.0) / 100.0;
+}
+
+QVector<MonthlySales> Reports::monthlySales(const QueryResult &result)
+{
+    QVector<MonthlySales> rows;
+    rows.reserve(result.rowCount());
+    int monthColumn = result.columnIndex("Month");
+    int salesColumn = result.columnIndex("TotalSales");
+    for (int row = 0; row < result.rowCount(); ++row) {
+        QString month = result.value(row, monthColumn).toString();
+        rows.append({month, month.left(4).toInt(), month.mid(5, 2).toInt(),
+                     result.value(row, salesColumn).toDouble()});
+    }
+    return rows;
+}
+
+QVector<GenreRevenue> Reports::revenueByGenre(const QueryResult &result)
+{
+    QVector<GenreRevenue> rows;
+    rows.reserve(result.rowCount());
+    int genreColumn = result.columnIndex("GenreName");
+    int revenueColumn = result.columnIndex("Revenue");
+    for (int row = 0; row < result.rowCount(); ++row) {
+        rows.append({result.value(row, genreColumn).toString(),
+                     result.value(row, revenueColumn).toDouble()});
+    }
+    return rows;
+}
+
+QVector<ArtistGenreSales> Reports::artistsByGenre(const QueryResult &result)
+{
+    QVector<ArtistGenreSales> rows;
+    rows.reserve(result.rowCount());
+    int genreColumn = result.columnIndex("GenreName");
+    int artistColumn = result.columnIndex("ArtistName");
+    int salesColumn = result.columnIndex("TotalSales");
+    int position = 0;
+    for (int row = 0; row < result.rowCount(); ++row) {
+        ArtistGenreSales current = {result.value(row, genreColumn).toString(),
+                                    result.value(row, artistColumn).toString(),
+                                    result.value(row, salesColumn).toInt(), 1};
+
+        // Строки отсортированы по жанру и убыванию продаж, поэтому ранг
+        // считается так же, как RANK(): равные продажи делят один ранг
+        if (!rows.isEmpty() && rows.last().genre == current.genre) {
+            ++position;
+            if (rows.last().sales == current.sales) {
+                current.rank = rows.last().rank;
+            } else {
+                current.rank = position;
+            }
+        } else {
+            position = 1;
+        }
+        rows.append(current);
+    }
+    return rows;
+}
+
+QVector<ArtistRevenue> Reports::topArtists(const QueryResult &result)
+{
+    QVector<ArtistRevenue> rows;
+    rows.reserve(result.rowCount());
+    int artistColumn = result.columnIndex("ArtistName");
+    int quantityColumn = result.columnIndex("TotalQuantity");
+    int revenueColumn = result.columnIndex("TotalSales");
+    for (int row = 0; row < result.rowCount(); ++row) {
+        rows.append({result.value(row, artistColumn).toString(),
+                     result.value(row, quantityColumn).toInt(),
+                     result.value(row, revenueColumn).toDouble()});
+    }
+    return rows;
+}
+
+QVector<CountryGenreSales> Reports::salesByCountryGenre(const QueryResult &result)
+{
+    QVector<CountryGenreSales> rows;
+    rows.reserve(result.rowCount());
+    int countryColumn = result.columnIndex("BillingCountry");
+    int genreColumn = result.columnIndex("GenreName");
+    int quantityColumn = result.columnIndex("TotalQuantity");
+    int revenueColumn = result.columnIndex("TotalSales");
+    for (int row = 0; row < result.rowCount(); ++row) {
+        rows.append({result.value(row, countryColumn).toString(),
+                     result.value(row, genreColumn).toString(),
+                     result.value(row, quantityColumn).toDouble(),
+                     result.value(row, revenueColumn).toDouble()});
+    }
+    return rows;
+}
+
+QVector<CitySales> Reports::salesByCity(const QueryResult &result)
+{
+    QVector<CitySales> rows;
+    rows.reserve(result.rowCount());
+    int countryColumn = result.columnIndex("BillingCountry");
+    int cityColumn = result.columnIndex("BillingCity");
+    int quantityColumn = result.columnIndex("TotalQuantity");
+    int revenueColumn = result.columnIndex("TotalSales");
+    for (int row = 0; row < result.rowCount(); ++row) {
+        rows.append({result.value(row, countryColumn).toString(),
+                     result.value(row, cityColumn).toString(),
+                     result.value(row, quantityColumn).toDouble(),
+                     result.value(row, revenueColumn).toDouble()});
+    }
+    return rows;
+}
+
+QueryResult Reports::topArtistsByGenreTable(const QVector<ArtistGenreSales> &rows, int topN)
+{
+    QueryResult table;
+    table.columns << "GenreName" << "ArtistName" << "TotalSales";
+    for (const ArtistGenreSales &row : rows) {
+        if (row.rank <= topN) {
+            table.appendRow({row.genre, row.artist, row.sales});
+        }
+    }
+    return table;
+}
+
+namespace
+{
+
+// Итоги по странам по убыванию выручки
+template <typename Row>
+QVector<CountryRevenue> sumByCountry(const QVector<Row> &rows)
+{
+    QMap<QString, double> totals;
+    for (const Row &row : rows) {
+        totals[row.country] += row.revenue;
+    }
+
+    QVector<CountryRevenue> countries;
+    countries.reserve(totals.size());
+    for (auto it = totals.constBegin(); it != totals.constEnd(); ++it) {
+        countries.append({it.key(), Reports::roundToCents(it.value())});
+    }
+    std::stable_sort(countries.begin(), countries.end(),
+                     [](const CountryRevenue &a, const CountryRevenue &b) {
+        return a.revenue > b.revenue;
+    });
+    return countries;
+}
+
+} // namespace
+
+QVector<CountryRevenue> Reports::countryTotals(const QVector<CountryGenreSales> &rows)
+{
+    return sumByCountry(rows);
+}
+
+QVector<CountryRevenue> Reports::countryTotals(const QVector<CitySales> &rows)
+{
+    return sumByCountry(rows);
+}
+
+QMap<QString, QMap<QString, double>> Reports::countryGenreQuantities(const QVector<CountryGenreSales> &rows)
+{
+    QMap<QString, QMap<QString, double>> mapData; // Map<Country, Map<Genre, Sales>>
+    for (const CountryGenreSales &row : rows) {
+        mapData[row.country][row.genre] += row.quantity;
+    }
+    return mapData;
+}
+
+QueryResult Reports::countryTotalsTable(const QVector<CountryRevenue> &rows)
+{
+    QueryResult table;
+    table.columns << "BillingCountry" << "TotalSales";
+    for (const CountryRevenue &row : rows) {
+        table.appendRow({row.country, row.revenue});
+    }
+    return table;
+}
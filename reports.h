@@ -0,0 +1,115 @@
+#ifndef REPORTS_H
+#define REPORTS_H
+
+#include "queryresult.h"
+#include "sqldialect.h"
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+// Отчёты приложения. Каждый отчёт выполняется одним запросом,
+// результат которого используют таблица, диаграмма и сцена
+enum class ReportId
+{
+    MonthlySales,
+    RevenueByGenre,
+    ArtistsByGenre,
+    TopArtists,
+    SalesByCountryGenre,
+    SalesByCity
+};
+
+struct ReportDefinition
+{
+    ReportId id;
+    QString name;
+    QString sql;       // с параметрами фильтров, см. Reports::defaultParams()
+    QString rollupSql; // тот же результат без фильтров по таблицам rollup_* (см. SalesRollup); только SQLite
+};
+
+// Типизированные строки результатов отчётов
+struct MonthlySales
+{
+    QString month;   // "YYYY-MM"
+    int year;
+    int monthOfYear; // 1..12
+    double quantity;
+};
+
+struct GenreRevenue
+{
+    QString genre;
+    double revenue;
+};
+
+struct ArtistGenreSales
+{
+    QString genre;
+    QString artist;
+    int sales;
+    int rank;        // RANK() внутри жанра по убыванию продаж
+};
+
+struct ArtistRevenue
+{
+    QString artist;
+    int quantity;
+    double revenue;
+};
+
+struct CountryGenreSales
+{
+    QString country;
+    QString genre;
+    double quantity;
+    double revenue;
+};
+
+struct CitySales
+{
+    QString country;
+    QString city;
+    double quantity;
+    double revenue;
+};
+
+struct CountryRevenue
+{
+    QString country;
+    double revenue;
+};
+
+namespace Reports
+{
+    // SQL отчётов для заданной СУБД; имена и столбцы результатов одинаковы
+    const ReportDefinition &definition(ReportId id, SqlDialect dialect = SqlDialect::Sqlite);
+    QList<ReportDefinition> all(SqlDialect dialect = SqlDialect::Sqlite);
+
+    // Значения параметров фильтров отчётов (:dateFrom, :dateTo, :country,
+    // :genreId, :limit) без ограничений; параметры запроса их перекрывают
+    QVariantMap defaultParams();
+    bool findByName(const QString &name, ReportId *id);
+
+    // Округление выручки так же, как ROUND(x, 2) в SQL отчётов
+    double roundToCents(double value);
+
+    QVector<MonthlySales> monthlySales(const QueryResult &result);
+    QVector<GenreRevenue> revenueByGenre(const QueryResult &result);
+    QVector<ArtistGenreSales> artistsByGenre(const QueryResult &result);
+    QVector<ArtistRevenue> topArtists(const QueryResult &result);
+    QVector<CountryGenreSales> salesByCountryGenre(const QueryResult &result);
+    QVector<CitySales> salesByCity(const QueryResult &result);
+
+    // Производные наборы, которые не требуют отдельного запроса
+    QVector<CountryRevenue> countryTotals(const QVector<CountryGenreSales> &rows);
+    QVector<CountryRevenue> countryTotals(const QVector<CitySales> &rows);
+    QMap<QString, QMap<QString, double>> countryGenreQuantities(const QVector<CountryGenreSales> &rows);
+
+    // Табличные представления типизированных строк
+    QueryResult topArtistsByGenreTable(const QVector<ArtistGenreSales> &rows, int topN);
+    QueryResult countryTotalsTable(const QVector<CountryRevenue> &rows);
+}
+
+#endif // REPORTS_H
@@ -0,0 +1,69 @@
+#include "resulttablemodel.h"
+
+ResultTableModel::ResultTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , loadedRows(0)
+{
+}
+
+void ResultTableModel::setResult(const QueryResult &result, const QStringList &columnHeaders)
+{
+    // Модель переиспользуется между отчётами: старый буфер освобождается здесь
+    beginResetModel();
+    source = result;
+    headers = columnHeaders;
+    loadedRows = qMin(source.rowCount(), int(FetchBatchSize));
+    endResetModel();
+}
+
+int ResultTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : loadedRows;
+}
+
+int ResultTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : headers.size();
+}
+
+QVariant ResultTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= loadedRows || index.column() >= source.columnCount()) {
+        return QVariant();
+    }
+    if (role == Qt::DisplayRole) {
+        return source.value(index.row(), index.column()).toString();
+    }
+    return QVariant();
+}
+
+QVariant ResultTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return headers.value(section);
+    }
+    return section + 1;
+}
+
+bool ResultTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && loadedRows < source.rowCount();
+}
+
+void ResultTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    int remaining = source.rowCount() - loadedRows;
+    int batch = qMin(remaining, int(FetchBatchSize));
+    if (batch <= 0) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), loadedRows, loadedRows + batch - 1);
+    loadedRows += batch;
+    endInsertRows();
+}
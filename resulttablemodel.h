@@ -0,0 +1,37 @@
+#ifndef RESULTTABLEMODEL_H
+#define RESULTTABLEMODEL_H
+
+#include "queryresult.h"
+#include <QAbstractTableModel>
+#include <QStringList>
+
+// Модель таблицы поверх столбцового QueryResult. Ячейки форматируются
+// только при запросе data(), а строки открываются представлению порциями
+// через canFetchMore/fetchMore по мере прокрутки
+class ResultTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    static const int FetchBatchSize = 256;
+
+    explicit ResultTableModel(QObject *parent = nullptr);
+
+    void setResult(const QueryResult &result, const QStringList &columnHeaders);
+    const QueryResult &result() const { return source; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    QueryResult source;
+    QStringList headers;
+    int loadedRows;
+};
+
+#endif // RESULTTABLEMODEL_H
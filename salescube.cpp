@@ -0,0 +1,377 @@
+#include "salescube.h"
+#include "servercursor.h"
+#include "sqldialect.h"
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+
+// Условия совпадают с фильтрами отчётов при значениях по умолчанию:
+// строки без даты в отчёты не попадают, строки без страны, трека или
+// жанра остаются (их жанр — NoKey). %1 — выражение месяца для СУБД
+const char *const CubeSql = R"(
+    SELECT invoices.BillingCountry, invoices.BillingCity, genres.GenreId, genres.Name,
+           %1 AS Month,
+           artists.ArtistId, artists.Name,
+           SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+    FROM invoice_items
+    JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+    LEFT JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+    LEFT JOIN genres ON tracks.GenreId = genres.GenreId
+    LEFT JOIN albums ON tracks.AlbumId = albums.AlbumId
+    LEFT JOIN artists ON albums.ArtistId = artists.ArtistId
+    WHERE invoices.InvoiceDate >= '0001-01-01' AND invoices.InvoiceDate < '9999-12-31'
+    GROUP BY invoices.BillingCountry, invoices.BillingCity, tracks.GenreId, genres.GenreId, genres.Name, Month,
+             artists.ArtistId, artists.Name)";
+
+struct Totals
+{
+    bool present = false;
+    qint64 quantity = 0;
+    double revenue = 0.0;
+};
+
+// Списки ячеек по коду измерения в формате CSR
+void buildSlices(const QVector<quint32> &keys, int keyCount, QVector<int> *start, QVector<int> *cells)
+{
+    start->fill(0, keyCount + 1);
+    for (quint32 key : keys) {
+        if (key != SalesCube::NoKey) {
+            ++(*start)[int(key) + 1];
+        }
+    }
+    for (int key = 0; key < keyCount; ++key) {
+        (*start)[key + 1] += (*start)[key];
+    }
+    cells->resize(start->last());
+    QVector<int> fill = *start;
+    for (int cell = 0; cell < keys.size(); ++cell) {
+        if (keys[cell] != SalesCube::NoKey) {
+            (*cells)[fill[int(keys[cell])]++] = cell;
+        }
+    }
+}
+
+} // namespace
+
+const quint32 SalesCube::NoKey;
+
+bool SalesCube::load(QSqlDatabase &db, int fetchSize, QString *error)
+{
+    QHash<QString, quint32> countryCodes;
+    QHash<QString, quint32> cityCodes; // "страна\x1fгород": одноимённые города разных стран различаются
+    QHash<qint64, quint32> genreCodes;
+    QHash<QString, quint32> monthCodes;
+    QHash<qint64, quint32> artistCodes;
+    QStringList cityKeys;
+    QString sql = QString(CubeSql).arg(Dialect::monthOf(Dialect::of(db), "invoices.InvoiceDate"));
+    QString loadError;
+    bool ok = ServerCursor::forEachRow(db, sql, fetchSize, [&](const QSqlQuery &query) {
+        quint32 country = DictionaryCodes::internName(countryCodes, countryNames, query.value(0).toString());
+        QString city = query.value(1).toString();
+        quint32 cityCode = DictionaryCodes::internName(cityCodes, cityKeys,
+                                                       query.value(0).toString() + QChar(0x1f) + city);
+        if (int(cityCode) == cityNames.size()) {
+            cityNames.append(city);
+            cityCountry.append(country);
+        }
+        cellCountry.append(country);
+        cellCity.append(cityCode);
+        cellGenre.append(DictionaryCodes::internId(genreCodes, genreNames, query.value(2), query.value(3)));
+        cellMonth.append(DictionaryCodes::internName(monthCodes, monthNames, query.value(4).toString()));
+        cellArtist.append(DictionaryCodes::internId(artistCodes, artistNames, query.value(5), query.value(6)));
+        cellQuantity.append(query.value(7).toLongLong());
+        cellRevenue.append(query.value(8).toDouble());
+        return true;
+    }, &loadError);
+    if (!ok) {
+        if (error) {
+            *error = loadError;
+        }
+        return false;
+    }
+
+    buildSlices(cellCountry, countryNames.size(), &countryStart, &countryCells);
+    buildSlices(cellGenre, genreNames.size(), &genreStart, &genreCells);
+    return true;
+}
+
+template <typename Visitor>
+void SalesCube::forEachCell(const CrossFilter &filter, Visitor visit) const
+{
+    int country = filter.country.isEmpty() ? -1 : countryNames.indexOf(filter.country);
+    int genre = filter.genre.isEmpty() ? -1 : genreNames.indexOf(filter.genre);
+    if ((!filter.country.isEmpty() && country < 0) || (!filter.genre.isEmpty() && genre < 0)) {
+        return; // Значения нет в данных: срез пуст
+    }
+
+    if (country < 0 && genre < 0) {
+        for (int cell = 0; cell < cellQuantity.size(); ++cell) {
+            visit(cell);
+        }
+        return;
+    }
+
+    // Идём по меньшему из срезов, второе условие проверяем на ячейке
+    int countrySize = country >= 0 ? countryStart[country + 1] - countryStart[country] : INT_MAX;
+    int genreSize = genre >= 0 ? genreStart[genre + 1] - genreStart[genre] : INT_MAX;
+    if (countrySize <= genreSize) {
+        for (int k = countryStart[country]; k < countryStart[country + 1]; ++k) {
+            int cell = countryCells[k];
+            if (genre < 0 || cellGenre[cell] == quint32(genre)) {
+                visit(cell);
+            }
+        }
+    } else {
+        for (int k = genreStart[genre]; k < genreStart[genre + 1]; ++k) {
+            int cell = genreCells[k];
+            if (country < 0 || cellCountry[cell] == quint32(country)) {
+                visit(cell);
+            }
+        }
+    }
+}
+
+QueryResult SalesCube::run(ReportId report, const CrossFilter &filter) const
+{
+    switch (report) {
+    case ReportId::MonthlySales:
+        return monthlySales(filter);
+    case ReportId::RevenueByGenre:
+        return revenueByGenre(filter);
+    case ReportId::ArtistsByGenre:
+        return artistsByGenre(filter);
+    case ReportId::TopArtists:
+        return topArtists(filter, Reports::defaultParams().value(":limit").toInt());
+    case ReportId::SalesByCountryGenre:
+        return salesByCountryGenre(filter);
+    case ReportId::SalesByCity:
+        return salesByCity(filter);
+    }
+    QueryResult result;
+    result.error = "Report is not supported by the sales cube";
+    return result;
+}
+
+QueryResult SalesCube::monthlySales(const CrossFilter &filter) const
+{
+    QVector<Totals> months(monthNames.size());
+    forEachCell(filter, [&](int cell) {
+        Totals &month = months[int(cellMonth[cell])];
+        month.present = true;
+        month.quantity += cellQuantity[cell];
+    });
+
+    QVector<QPair<QString, qint64>> rows;
+    for (int month = 0; month < months.size(); ++month) {
+        if (months[month].present) {
+            rows.append(qMakePair(monthNames.at(month), months[month].quantity));
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+
+    QueryResult result;
+    result.columns << "Month" << "TotalSales";
+    for (const auto &row : rows) {
+        result.appendRow({row.first, row.second});
+    }
+    return result;
+}
+
+QueryResult SalesCube::revenueByGenre(const CrossFilter &filter) const
+{
+    CrossFilter ownFilter = filter;
+    ownFilter.genre.clear();
+
+    QVector<Totals> genres(genreNames.size());
+    forEachCell(ownFilter, [&](int cell) {
+        if (cellGenre[cell] == NoKey) {
+            return;
+        }
+        Totals &genre = genres[int(cellGenre[cell])];
+        genre.present = true;
+        genre.revenue += cellRevenue[cell];
+    });
+
+    QVector<QPair<QString, double>> rows;
+    for (int genre = 0; genre < genres.size(); ++genre) {
+        if (genres[genre].present) {
+            rows.append(qMakePair(genreNames.at(genre), Reports::roundToCents(genres[genre].revenue)));
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const QPair<QString, double> &a, const QPair<QString, double> &b) {
+        return a.second > b.second;
+    });
+
+    QueryResult result;
+    result.columns << "GenreName" << "Revenue";
+    for (const auto &row : rows) {
+        result.appendRow({row.first, row.second});
+    }
+    return result;
+}
+
+QueryResult SalesCube::artistsByGenre(const CrossFilter &filter) const
+{
+    const quint64 artistCount = quint64(artistNames.size());
+    QHash<quint64, qint64> groups;
+    forEachCell(filter, [&](int cell) {
+        if (cellGenre[cell] == NoKey || cellArtist[cell] == NoKey) {
+            return;
+        }
+        groups[quint64(cellGenre[cell]) * artistCount + cellArtist[cell]] += cellQuantity[cell];
+    });
+
+    struct Row
+    {
+        quint32 genre;
+        quint32 artist;
+        qint64 sales;
+    };
+    QVector<Row> rows;
+    rows.reserve(groups.size());
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        rows.append({quint32(it.key() / artistCount), quint32(it.key() % artistCount), it.value()});
+    }
+    std::sort(rows.begin(), rows.end(), [this](const Row &a, const Row &b) {
+        int order = genreNames.at(int(a.genre)).compare(genreNames.at(int(b.genre)));
+        if (order != 0) {
+            return order < 0;
+        }
+        return a.sales > b.sales;
+    });
+
+    QueryResult result;
+    result.columns << "GenreName" << "ArtistName" << "TotalSales";
+    for (const Row &row : rows) {
+        result.appendRow({genreNames.at(int(row.genre)), artistNames.at(int(row.artist)), row.sales});
+    }
+    return result;
+}
+
+QueryResult SalesCube::topArtists(const CrossFilter &filter, int limit) const
+{
+    QVector<Totals> artists(artistNames.size());
+    forEachCell(filter, [&](int cell) {
+        if (cellArtist[cell] == NoKey) {
+            return;
+        }
+        Totals &artist = artists[int(cellArtist[cell])];
+        artist.present = true;
+        artist.quantity += cellQuantity[cell];
+        artist.revenue += cellRevenue[cell];
+    });
+
+    struct Row
+    {
+        quint32 artist;
+        qint64 quantity;
+        double revenue;
+    };
+    QVector<Row> rows;
+    for (int artist = 0; artist < artists.size(); ++artist) {
+        if (artists[artist].present) {
+            rows.append({quint32(artist), artists[artist].quantity, Reports::roundToCents(artists[artist].revenue)});
+        }
+    }
+
+    int count = qMin(limit, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [](const Row &a, const Row &b) {
+        return a.revenue > b.revenue;
+    });
+
+    QueryResult result;
+    result.columns << "ArtistName" << "TotalQuantity" << "TotalSales";
+    for (int i = 0; i < count; ++i) {
+        result.appendRow({artistNames.at(int(rows[i].artist)), rows[i].quantity, rows[i].revenue});
+    }
+    return result;
+}
+
+QueryResult SalesCube::salesByCountryGenre(const CrossFilter &filter) const
+{
+    CrossFilter ownFilter = filter;
+    ownFilter.country.clear();
+
+    const quint64 genreCount = quint64(genreNames.size());
+    QHash<quint64, Totals> groups;
+    forEachCell(ownFilter, [&](int cell) {
+        if (cellGenre[cell] == NoKey) {
+            return;
+        }
+        Totals &group = groups[quint64(cellCountry[cell]) * genreCount + cellGenre[cell]];
+        group.quantity += cellQuantity[cell];
+        group.revenue += cellRevenue[cell];
+    });
+
+    struct Row
+    {
+        quint32 country;
+        quint32 genre;
+        qint64 quantity;
+        double revenue;
+    };
+    QVector<Row> rows;
+    rows.reserve(groups.size());
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        rows.append({quint32(it.key() / genreCount), quint32(it.key() % genreCount), it.value().quantity,
+                     Reports::roundToCents(it.value().revenue)});
+    }
+    std::sort(rows.begin(), rows.end(), [this](const Row &a, const Row &b) {
+        int order = countryNames.at(int(a.country)).compare(countryNames.at(int(b.country)));
+        if (order != 0) {
+            return order < 0;
+        }
+        if (a.quantity != b.quantity) {
+            return a.quantity > b.quantity;
+        }
+        return genreNames.at(int(a.genre)) < genreNames.at(int(b.genre));
+    });
+
+    QueryResult result;
+    result.columns << "BillingCountry" << "GenreName" << "TotalQuantity" << "TotalSales";
+    for (const Row &row : rows) {
+        result.appendRow({countryNames.at(int(row.country)), genreNames.at(int(row.genre)), row.quantity, row.revenue});
+    }
+    return result;
+}
+
+QueryResult SalesCube::salesByCity(const CrossFilter &filter) const
+{
+    CrossFilter ownFilter = filter;
+    ownFilter.country.clear();
+
+    QVector<Totals> cities(cityNames.size());
+    forEachCell(ownFilter, [&](int cell) {
+        Totals &city = cities[int(cellCity[cell])];
+        city.present = true;
+        city.quantity += cellQuantity[cell];
+        city.revenue += cellRevenue[cell];
+    });
+
+    QVector<int> rows;
+    for (int city = 0; city < cities.size(); ++city) {
+        if (cities[city].present) {
+            rows.append(city);
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [this](int a, int b) {
+        int order = countryNames.at(int(cityCountry[a])).compare(countryNames.at(int(cityCountry[b])));
+        if (order != 0) {
+            return order < 0;
+        }
+        return cityNames.at(a) < cityNames.at(b);
+    });
+
+    QueryResult result;
+    result.columns << "BillingCountry" << "BillingCity" << "TotalQuantity" << "TotalSales";
+    for (int city : rows) {
+        result.appendRow({countryNames.at(int(cityCountry[city])), cityNames.at(city), cities[city].quantity,
+                          Reports::roundToCents(cities[city].revenue)});
+    }
+    return result;
+}
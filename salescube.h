@@ -0,0 +1,85 @@
+#ifndef SALESCUBE_H
+#define SALESCUBE_H
+
+#include "dictionarycodes.h"
+#include "queryresult.h"
+#include "reports.h"
+#include <QMetaType>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVector>
+
+// Перекрёстный фильтр представлений: страна и жанр по имени,
+// пустая строка — без ограничения
+struct CrossFilter
+{
+    QString country;
+    QString genre;
+
+    bool isEmpty() const { return country.isEmpty() && genre.isEmpty(); }
+};
+
+// Куб продаж страна x город x жанр x месяц x артист. Загружается одним
+// запросом с GROUP BY по всем измерениям; ячейка хранит SUM(Quantity) и
+// неокруглённую SUM(Quantity * UnitPrice). Для каждой страны и каждого
+// жанра заранее собраны списки ячеек (срезы), поэтому отчёт с фильтром
+// проходит только по нужному срезу, без повторных соединений в SQL.
+// Результаты совпадают с SQL-отчётами по столбцам, порядку и округлению
+class SalesCube
+{
+public:
+    static const quint32 NoKey = DictionaryCodes::NoKey;
+
+    // fetchSize > 0 — на PostgreSQL ячейки читаются порциями через курсор
+    bool load(QSqlDatabase &db, int fetchSize = 0, QString *error = nullptr);
+
+    int cellCount() const { return cellQuantity.size(); }
+    QStringList countries() const { return countryNames; }
+    QStringList genres() const { return genreNames; }
+
+    // Отчёт не фильтруется по своему основному измерению: выручка по
+    // жанрам — по жанру, отчёты карты — по стране. Выбранное значение
+    // на таком представлении выделяется, остальные остаются видны
+    QueryResult run(ReportId report, const CrossFilter &filter) const;
+
+private:
+    template <typename Visitor>
+    void forEachCell(const CrossFilter &filter, Visitor visit) const;
+
+    QueryResult monthlySales(const CrossFilter &filter) const;
+    QueryResult revenueByGenre(const CrossFilter &filter) const;
+    QueryResult artistsByGenre(const CrossFilter &filter) const;
+    QueryResult topArtists(const CrossFilter &filter, int limit) const;
+    QueryResult salesByCountryGenre(const CrossFilter &filter) const;
+    QueryResult salesByCity(const CrossFilter &filter) const;
+
+    // Словари измерений: код -> имя
+    QStringList countryNames;
+    QStringList cityNames;        // город без страны
+    QVector<quint32> cityCountry; // код города -> код страны
+    QStringList genreNames;
+    QStringList monthNames;
+    QStringList artistNames;
+
+    // Ячейки куба, по элементу на непустую комбинацию измерений
+    QVector<quint32> cellCountry;
+    QVector<quint32> cellCity;
+    QVector<quint32> cellGenre;  // NoKey, если жанра нет в genres
+    QVector<quint32> cellMonth;
+    QVector<quint32> cellArtist; // NoKey, если нет альбома или артиста
+    QVector<qint64> cellQuantity;
+    QVector<double> cellRevenue;
+
+    // Срезы в формате CSR: ячейки страны c — countryCells[countryStart[c]..countryStart[c + 1])
+    QVector<int> countryStart;
+    QVector<int> countryCells;
+    QVector<int> genreStart;
+    QVector<int> genreCells;
+};
+
+typedef QSharedPointer<const SalesCube> SalesCubePtr;
+
+Q_DECLARE_METATYPE(SalesCubePtr)
+
+#endif // SALESCUBE_H
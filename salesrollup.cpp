@@ -0,0 +1,218 @@
+#include "salesrollup.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+namespace
+{
+
+const char *const schemaStatements[] = {
+    R"(CREATE TABLE IF NOT EXISTS rollup_state (
+           Name TEXT PRIMARY KEY,
+           Watermark INTEGER NOT NULL))",
+    R"(CREATE TABLE IF NOT EXISTS rollup_monthly_sales (
+           Month TEXT PRIMARY KEY,
+           Quantity INTEGER NOT NULL,
+           Revenue REAL NOT NULL))",
+    R"(CREATE TABLE IF NOT EXISTS rollup_genre_sales (
+           GenreId INTEGER PRIMARY KEY,
+           Quantity INTEGER NOT NULL,
+           Revenue REAL NOT NULL))",
+    R"(CREATE TABLE IF NOT EXISTS rollup_artist_sales (
+           ArtistId INTEGER PRIMARY KEY,
+           Quantity INTEGER NOT NULL,
+           Revenue REAL NOT NULL))",
+    R"(CREATE TABLE IF NOT EXISTS rollup_country_genre_sales (
+           BillingCountry TEXT NOT NULL,
+           GenreId INTEGER NOT NULL,
+           Quantity INTEGER NOT NULL,
+           Revenue REAL NOT NULL,
+           PRIMARY KEY (BillingCountry, GenreId)))"
+};
+
+const char *const rollupTables[] = {
+    "rollup_monthly_sales",
+    "rollup_genre_sales",
+    "rollup_artist_sales",
+    "rollup_country_genre_sales"
+};
+
+// Дельта по диапазону счетов (:from, :to] прибавляется к уже накопленным суммам.
+// Соединения совпадают с исходными отчётами, чтобы отбрасывались те же строки
+const char *const updateStatements[] = {
+    R"(INSERT INTO rollup_monthly_sales (Month, Quantity, Revenue)
+       SELECT strftime('%Y-%m', invoices.InvoiceDate), SUM(invoice_items.Quantity),
+              SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+       FROM invoice_items
+       JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+       WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+       GROUP BY 1
+       ON CONFLICT(Month) DO UPDATE SET Quantity = Quantity + excluded.Quantity,
+                                        Revenue = Revenue + excluded.Revenue)",
+    R"(INSERT INTO rollup_genre_sales (GenreId, Quantity, Revenue)
+       SELECT genres.GenreId, SUM(invoice_items.Quantity),
+              SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+       FROM invoice_items
+       JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+       JOIN genres ON tracks.GenreId = genres.GenreId
+       WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+       GROUP BY genres.GenreId
+       ON CONFLICT(GenreId) DO UPDATE SET Quantity = Quantity + excluded.Quantity,
+                                          Revenue = Revenue + excluded.Revenue)",
+    R"(INSERT INTO rollup_artist_sales (ArtistId, Quantity, Revenue)
+       SELECT artists.ArtistId, SUM(invoice_items.Quantity),
+              SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+       FROM invoice_items
+       JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+       JOIN albums ON tracks.AlbumId = albums.AlbumId
+       JOIN artists ON albums.ArtistId = artists.ArtistId
+       WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+       GROUP BY artists.ArtistId
+       ON CONFLICT(ArtistId) DO UPDATE SET Quantity = Quantity + excluded.Quantity,
+                                           Revenue = Revenue + excluded.Revenue)",
+    R"(INSERT INTO rollup_country_genre_sales (BillingCountry, GenreId, Quantity, Revenue)
+       SELECT invoices.BillingCountry, genres.GenreId, SUM(invoice_items.Quantity),
+              SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+       FROM invoice_items
+       JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+       JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+       JOIN genres ON tracks.GenreId = genres.GenreId
+       WHERE invoice_items.InvoiceId > :from AND invoice_items.InvoiceId <= :to
+       GROUP BY invoices.BillingCountry, genres.GenreId
+       ON CONFLICT(BillingCountry, GenreId) DO UPDATE SET Quantity = Quantity + excluded.Quantity,
+                                                          Revenue = Revenue + excluded.Revenue)"
+};
+
+bool readWatermark(QSqlQuery &query, qint64 *watermark)
+{
+    if (!query.exec("SELECT Watermark FROM rollup_state WHERE Name = 'sales'")) {
+        return false;
+    }
+    *watermark = query.next() ? query.value(0).toLongLong() : 0;
+    return true;
+}
+
+bool readMaxInvoiceId(QSqlQuery &query, qint64 *maxInvoiceId)
+{
+    if (!query.exec("SELECT COALESCE(MAX(InvoiceId), 0) FROM invoices") || !query.next()) {
+        return false;
+    }
+    *maxInvoiceId = query.value(0).toLongLong();
+    return true;
+}
+
+} // namespace
+
+SalesRollup::SalesRollup()
+    : schemaReady(false)
+    , unavailable(false)
+    , processedInvoiceId(0)
+{
+}
+
+bool SalesRollup::ensureSchema(QSqlDatabase &db)
+{
+    if (schemaReady) {
+        return true;
+    }
+    if (unavailable) {
+        return false;
+    }
+
+    QSqlQuery query(db);
+    for (const char *statement : schemaStatements) {
+        if (!query.exec(statement)) {
+            // Скорее всего БД только для чтения — отчёты пойдут по исходным таблицам
+            qDebug() << "Rollup schema error:" << query.lastError().text();
+            unavailable = true;
+            return false;
+        }
+    }
+
+    processedInvoiceId = 0;
+    readWatermark(query, &processedInvoiceId);
+    schemaReady = true;
+    return true;
+}
+
+bool SalesRollup::refresh(QSqlDatabase &db)
+{
+    if (!ensureSchema(db)) {
+        return false;
+    }
+
+    // Сравнение с запомненной отметкой только отсекает холостые вызовы;
+    // диапазон определяется в applyRange по отметке из базы
+    qint64 maxInvoiceId = 0;
+    {
+        QSqlQuery query(db);
+        if (!readMaxInvoiceId(query, &maxInvoiceId)) {
+            return false;
+        }
+    }
+    if (maxInvoiceId == processedInvoiceId) {
+        return true;
+    }
+    return applyRange(db, false);
+}
+
+bool SalesRollup::rebuild(QSqlDatabase &db)
+{
+    if (!ensureSchema(db)) {
+        return false;
+    }
+    return applyRange(db, true);
+}
+
+bool SalesRollup::applyRange(QSqlDatabase &db, bool reset)
+{
+    if (!db.transaction()) {
+        return false;
+    }
+
+    // Отметку мог сдвинуть другой процесс (второй экземпляр, пакетная
+    // выгрузка, reportbench), поэтому и она, и максимум InvoiceId читаются
+    // в транзакции записи. Если другой процесс запишет раньше нас, наша
+    // запись получит SQLITE_BUSY и транзакция откатится, а не прибавит
+    // диапазон второй раз
+    bool ok = true;
+    qint64 fromInvoiceId = 0;
+    qint64 toInvoiceId = 0;
+    {
+        QSqlQuery query(db);
+        ok = readWatermark(query, &fromInvoiceId) && readMaxInvoiceId(query, &toInvoiceId);
+        if (toInvoiceId < fromInvoiceId) {
+            // Счета удалены — пересчитываем целиком
+            reset = true;
+        }
+        if (reset) {
+            fromInvoiceId = 0;
+            for (const char *table : rollupTables) {
+                ok = ok && query.exec(QString("DELETE FROM %1").arg(table));
+            }
+        }
+        // Досчитанный другим процессом диапазон пропускаем
+        if (ok && toInvoiceId > fromInvoiceId) {
+            for (const char *statement : updateStatements) {
+                ok = ok && query.prepare(statement);
+                query.bindValue(":from", fromInvoiceId);
+                query.bindValue(":to", toInvoiceId);
+                ok = ok && query.exec();
+            }
+            ok = ok && query.prepare("INSERT OR REPLACE INTO rollup_state (Name, Watermark) VALUES ('sales', :to)");
+            query.bindValue(":to", toInvoiceId);
+            ok = ok && query.exec();
+        }
+        if (!ok) {
+            qDebug() << "Rollup refresh error:" << query.lastError().text();
+        }
+    }
+
+    if (!ok || !db.commit()) {
+        db.rollback();
+        return false;
+    }
+
+    processedInvoiceId = toInvoiceId;
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef SALESROLLUP_H
+#define SALESROLLUP_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+// Материализованные агрегаты продаж (месяц, жанр, артист, страна x жанр).
+// Таблицы rollup_* хранятся в той же БД и дополняются только строками новых
+// счетов: обработанный максимум InvoiceId запоминается в rollup_state.
+// Агрегаты могут досчитывать и другие процессы, поэтому нижняя граница
+// берётся из rollup_state внутри транзакции записи.
+// Предполагается, что счета только добавляются; если InvoiceId уменьшился
+// (счета удалены), агрегаты пересчитываются целиком
+class SalesRollup
+{
+public:
+    SalesRollup();
+
+    // Досчитывает агрегаты по новым счетам. Возвращает false, если агрегаты
+    // недоступны (например, БД открыта только для чтения)
+    bool refresh(QSqlDatabase &db);
+    bool rebuild(QSqlDatabase &db);
+
+    qint64 watermark() const { return processedInvoiceId; }
+
+private:
+    bool ensureSchema(QSqlDatabase &db);
+    bool applyRange(QSqlDatabase &db, bool reset);
+
+    bool schemaReady;
+    bool unavailable;
+    qint64 processedInvoiceId;
+};
+
+#endif // SALESROLLUP_H
@@ -0,0 +1,99 @@
+#include "servercursor.h"
+#include "sqldialect.h"
+#include <QSqlError>
+
+bool ServerCursor::forEachRow(QSqlDatabase &db, const QString &sql, int fetchSize, const RowVisitor &visit,
+                              QString *error)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (fetchSize <= 0 || Dialect::of(db) != SqlDialect::Postgres) {
+        if (!query.exec(sql)) {
+            *error = query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            if (!visit(query)) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    ServerCursor cursor(db, "load_cursor");
+    if (!cursor.open(sql, error)) {
+        return false;
+    }
+    int batchRows;
+    do {
+        if (!cursor.fetch(fetchSize, &query, error)) {
+            return false;
+        }
+        batchRows = 0;
+        while (query.next()) {
+            if (!visit(query)) {
+                return true;
+            }
+            ++batchRows;
+        }
+    } while (batchRows == fetchSize);
+    return true;
+}
+
+ServerCursor::ServerCursor(QSqlDatabase &db, const QString &name)
+    : db(db)
+    , name(name)
+    , opened(false)
+{
+}
+
+ServerCursor::~ServerCursor()
+{
+    close();
+}
+
+bool ServerCursor::open(const QString &sql, QString *error)
+{
+    close();
+    if (!db.transaction()) {
+        *error = db.lastError().text();
+        return false;
+    }
+
+    QString select = sql.trimmed();
+    while (select.endsWith(';')) {
+        select.chop(1);
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec("SET TRANSACTION READ ONLY")
+            || !query.exec(QString("DECLARE %1 NO SCROLL CURSOR FOR %2").arg(name, select))) {
+        *error = query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    opened = true;
+    return true;
+}
+
+bool ServerCursor::fetch(int rows, QSqlQuery *query, QString *error)
+{
+    *query = QSqlQuery(db);
+    query->setForwardOnly(true);
+    if (!query->exec(QString("FETCH FORWARD %1 FROM %2").arg(qMax(1, rows)).arg(name))) {
+        *error = query->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void ServerCursor::close()
+{
+    if (!opened) {
+        return;
+    }
+    opened = false;
+    // Транзакция только читала, откат снимает курсор вместе с ней, в том
+    // числе после ошибки внутри транзакции
+    db.rollback();
+}
@@ -0,0 +1,44 @@
+#ifndef SERVERCURSOR_H
+#define SERVERCURSOR_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <functional>
+
+// Результат запроса PostgreSQL, читаемый порциями через курсор на сервере.
+// Обычный запрос QPSQL получает весь результат в память клиента сразу,
+// через курсор в памяти не больше одной порции FETCH. Курсор живёт в
+// транзакции только для чтения, которая завершается вместе с ним.
+// Курсор отключает параллельный план, поэтому короткие результаты
+// агрегатов выгоднее читать обычным запросом
+class ServerCursor
+{
+public:
+    // Обработчик строки; false прекращает чтение
+    typedef std::function<bool(const QSqlQuery &query)> RowVisitor;
+
+    // Все строки SELECT по очереди в visit. На PostgreSQL при fetchSize > 0
+    // строки читаются через курсор порциями по fetchSize, иначе обычным запросом
+    static bool forEachRow(QSqlDatabase &db, const QString &sql, int fetchSize, const RowVisitor &visit,
+                           QString *error);
+
+    explicit ServerCursor(QSqlDatabase &db, const QString &name = "report_cursor");
+    ~ServerCursor();
+
+    // sql — один SELECT с уже подставленными значениями параметров
+    bool open(const QString &sql, QString *error);
+
+    // Следующие rows строк в *query; пустая порция — строк больше нет
+    bool fetch(int rows, QSqlQuery *query, QString *error);
+
+    void close();
+    bool isOpen() const { return opened; }
+
+private:
+    QSqlDatabase db;
+    QString name;
+    bool opened;
+};
+
+#endif // SERVERCURSOR_H
@@ -0,0 +1,96 @@
+#include "sqldialect.h"
+#include "statementregistry.h"
+#include <QHash>
+#include <QRegularExpression>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <algorithm>
+
+QString Dialect::driverName(SqlDialect dialect)
+{
+    return dialect == SqlDialect::Postgres ? "QPSQL" : "QSQLITE";
+}
+
+SqlDialect Dialect::of(const QSqlDatabase &db)
+{
+    return db.driverName() == "QPSQL" ? SqlDialect::Postgres : SqlDialect::Sqlite;
+}
+
+bool Dialect::fromName(const QString &name, SqlDialect *dialect)
+{
+    QString value = name.trimmed().toLower();
+    if (value == "sqlite") {
+        *dialect = SqlDialect::Sqlite;
+        return true;
+    }
+    if (value == "postgres" || value == "postgresql") {
+        *dialect = SqlDialect::Postgres;
+        return true;
+    }
+    return false;
+}
+
+QString Dialect::name(SqlDialect dialect)
+{
+    return dialect == SqlDialect::Postgres ? "postgres" : "sqlite";
+}
+
+QString Dialect::monthOf(SqlDialect dialect, const QString &column)
+{
+    if (dialect == SqlDialect::Postgres) {
+        return QString("to_char(%1, 'YYYY-MM')").arg(column);
+    }
+    return QString("strftime('%Y-%m', %1)").arg(column);
+}
+
+QString Dialect::dayOf(SqlDialect dialect, const QString &column)
+{
+    if (dialect == SqlDialect::Postgres) {
+        return QString("to_char(%1, 'YYYY-MM-DD')").arg(column);
+    }
+    return QString("date(%1)").arg(column);
+}
+
+QString Dialect::inlineParams(const QSqlDatabase &db, const QString &sql, const QVariantMap &params,
+                              const QVariantMap &defaults)
+{
+    // Фильтры вида (CAST(:x AS ...) IS NULL OR col = :x) содержат параметр
+    // несколько раз, поэтому заменяется каждое вхождение. Все имена
+    // подставляются за один проход: уже подставленные значения повторно не
+    // просматриваются. Длинные имена стоят в шаблоне первыми, а за именем
+    // не может идти буква, поэтому :genreId не откусывает начало более
+    // длинного имени. Строковые литералы запроса не трогаются
+    QStringList names = StatementRegistry::placeholders(sql);
+    if (names.isEmpty()) {
+        return sql;
+    }
+    std::sort(names.begin(), names.end(), [](const QString &a, const QString &b) {
+        return a.size() > b.size();
+    });
+
+    QHash<QString, QString> literals;
+    QStringList alternatives;
+    for (const QString &placeholder : names) {
+        QVariant value = params.contains(placeholder) ? params.value(placeholder) : defaults.value(placeholder);
+        QSqlField field(QString(), value.type());
+        field.setValue(value);
+        literals.insert(placeholder, db.driver()->formatValue(field));
+        alternatives << QRegularExpression::escape(placeholder);
+    }
+
+    QRegularExpression pattern("'[^']*'|(?<![:\\w])(" + alternatives.join('|') + ")(?!\\w)");
+    QString result;
+    int last = 0;
+    QRegularExpressionMatchIterator it = pattern.globalMatch(sql);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        if (match.capturedStart(1) < 0) {
+            continue;
+        }
+        result += sql.midRef(last, match.capturedStart() - last);
+        result += literals.value(match.captured(1));
+        last = match.capturedEnd();
+    }
+    result += sql.midRef(last);
+    return result;
+}
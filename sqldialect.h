@@ -0,0 +1,34 @@
+#ifndef SQLDIALECT_H
+#define SQLDIALECT_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariantMap>
+
+// СУБД, на которой выполняются отчёты. SQL отчётов общий, различаются
+// только выражения над датами; всё остальное пишется так, чтобы его
+// понимали обе СУБД (COALESCE, псевдонимы в кавычках, ROUND по NUMERIC)
+enum class SqlDialect { Sqlite, Postgres };
+
+namespace Dialect
+{
+    // Имя драйвера Qt: QSQLITE или QPSQL
+    QString driverName(SqlDialect dialect);
+    SqlDialect of(const QSqlDatabase &db);
+
+    // sqlite, postgres или postgresql без учёта регистра
+    bool fromName(const QString &name, SqlDialect *dialect);
+    QString name(SqlDialect dialect);
+
+    // Текстовые "YYYY-MM" и "YYYY-MM-DD" по столбцу даты счёта
+    QString monthOf(SqlDialect dialect, const QString &column);
+    QString dayOf(SqlDialect dialect, const QString &column);
+
+    // Подставляет значения параметров :name в текст запроса литералами
+    // драйвера. Нужно для команд, которые сервер не готовит с параметрами
+    // (DECLARE CURSOR в PostgreSQL)
+    QString inlineParams(const QSqlDatabase &db, const QString &sql, const QVariantMap &params,
+                         const QVariantMap &defaults);
+}
+
+#endif // SQLDIALECT_H
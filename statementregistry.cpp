@@ -0,0 +1,57 @@
+#include "statementregistry.h"
+#include <QRegularExpression>
+#include <QSqlError>
+
+bool StatementRegistry::prepare(QSqlDatabase &db, const QString &name, const QString &sql, QString *error)
+{
+    if (entries.contains(name)) {
+        return true;
+    }
+
+    Entry entry{QSqlQuery(db), placeholders(sql)};
+    entry.query.setForwardOnly(true);
+    if (!entry.query.prepare(sql)) {
+        if (error) {
+            *error = entry.query.lastError().text();
+        }
+        return false;
+    }
+    entries.insert(name, entry);
+    return true;
+}
+
+bool StatementRegistry::exec(const QString &name, const QVariantMap &params, const QVariantMap &defaults,
+                             QSqlQuery *query)
+{
+    auto it = entries.find(name);
+    if (it == entries.end()) {
+        return false;
+    }
+
+    // Копия QSqlQuery разделяет с записью реестра один подготовленный запрос
+    *query = it->query;
+    for (const QString &placeholder : it->placeholders) {
+        query->bindValue(placeholder, params.contains(placeholder) ? params.value(placeholder)
+                                                                   : defaults.value(placeholder));
+    }
+    return query->exec();
+}
+
+QStringList StatementRegistry::placeholders(const QString &sql)
+{
+    static const QRegularExpression literals("'[^']*'");
+    static const QRegularExpression names("(?<![:\\w]):([A-Za-z_]\\w*)");
+
+    QString stripped = sql;
+    stripped.remove(literals);
+
+    QStringList result;
+    QRegularExpressionMatchIterator it = names.globalMatch(stripped);
+    while (it.hasNext()) {
+        QString placeholder = ":" + it.next().captured(1);
+        if (!result.contains(placeholder)) {
+            result << placeholder;
+        }
+    }
+    return result;
+}
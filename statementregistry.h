@@ -0,0 +1,42 @@
+#ifndef STATEMENTREGISTRY_H
+#define STATEMENTREGISTRY_H
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariantMap>
+
+// Именованные подготовленные запросы одного соединения. Каждый запрос
+// разбирается и планируется СУБД один раз, затем переиспользуется с новыми
+// значениями параметров. Запросы только для чтения вперёд, чтобы драйвер
+// не держал копию всего результата
+class StatementRegistry
+{
+public:
+    // Готовит запрос при первом обращении; повторный вызов с тем же именем
+    // ничего не делает
+    bool prepare(QSqlDatabase &db, const QString &name, const QString &sql, QString *error = nullptr);
+    bool contains(const QString &name) const { return entries.contains(name); }
+
+    // Привязывает параметры, которые есть в запросе, и выполняет его.
+    // Недостающие параметры берутся из defaults
+    bool exec(const QString &name, const QVariantMap &params, const QVariantMap &defaults, QSqlQuery *query);
+
+    // Освобождает запросы; вызывается до закрытия соединения
+    void clear() { entries.clear(); }
+
+    // Имена параметров вида :name вне строковых литералов
+    static QStringList placeholders(const QString &sql);
+
+private:
+    struct Entry
+    {
+        QSqlQuery query;
+        QStringList placeholders;
+    };
+
+    QHash<QString, Entry> entries;
+};
+
+#endif // STATEMENTREGISTRY_H
@@ -0,0 +1,312 @@
+#include "storageconfig.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QUrl>
+#include <QDebug>
+
+namespace
+{
+
+// chinook.db по умолчанию: рядом с программой (туда её кладёт сборка),
+// в рабочем каталоге, затем в каталоге исходников. Если файла нет нигде,
+// остаётся путь рядом с программой — open сообщит, что базы нет
+QString defaultDatabasePath()
+{
+    QStringList directories;
+    directories << QCoreApplication::applicationDirPath() << QDir::currentPath();
+#ifdef SALESANALYTICS_SOURCE_DIR
+    directories << QString::fromUtf8(SALESANALYTICS_SOURCE_DIR);
+#endif
+    for (const QString &directory : directories) {
+        QString path = QDir(directory).filePath("chinook.db");
+        if (QFileInfo(path).isFile()) {
+            return path;
+        }
+    }
+    return QDir(directories.first()).filePath("chinook.db");
+}
+
+} // namespace
+
+StorageConfig::StorageConfig()
+    : dialect(SqlDialect::Sqlite)
+    , mmapSize(qint64(1) << 30)
+    , cacheSizeKiB(64 * 1024)
+    , tempStoreMemory(true)
+    , wal(false)
+    , readOnly(false)
+    , immutable(false)
+    , busyTimeoutMs(5000)
+    , port(5432)
+    , fetchSize(10000)
+    , parallelWorkers(-1)
+{
+}
+
+void StorageConfig::addOptions(QCommandLineParser *parser)
+{
+    parser->addOptions({
+        {"config", "Файл настроек хранилища (INI, секция [storage]).", "file"},
+        {"backend", "СУБД: sqlite или postgres.", "name"},
+        {"db", "Путь к файлу SQLite или имя базы PostgreSQL.", "path"},
+        {"host", "Сервер PostgreSQL.", "host"},
+        {"port", "Порт PostgreSQL.", "port"},
+        {"user", "Пользователь PostgreSQL.", "name"},
+        {"fetch-size", "Строк на одну выборку из курсора PostgreSQL.", "rows"},
+        {"parallel-workers", "Параллельных процессов на узел Gather в PostgreSQL.", "count"},
+        {"mmap-size", "Сколько байт базы читать через mmap; 0 — отключить.", "bytes"},
+        {"cache-size", "Кэш страниц на соединение, КиБ.", "kib"},
+        {"temp-store", "Где строить временные структуры: memory или file.", "where"},
+        {"wal", "Перевести базу в режим WAL (меняет режим журнала в файле базы)."},
+        {"read-only", "Открыть базу только для чтения."},
+        {"immutable", "Открыть неизменяемый файл без блокировок (URI immutable=1)."}
+    });
+}
+
+StorageConfig StorageConfig::fromParser(const QCommandLineParser &parser)
+{
+    StorageConfig config;
+    if (parser.isSet("config")) {
+        if (!config.loadFile(parser.value("config"))) {
+            qDebug() << "Storage config not found:" << parser.value("config");
+        }
+    } else {
+        config.loadFile(QDir(QCoreApplication::applicationDirPath()).filePath("salesanalytics.ini"));
+    }
+
+    if (parser.isSet("backend") && !Dialect::fromName(parser.value("backend"), &config.dialect)) {
+        qDebug() << "Unknown backend:" << parser.value("backend");
+    }
+    if (parser.isSet("db")) {
+        config.databasePath = parser.value("db");
+    }
+    if (parser.isSet("host")) {
+        config.host = parser.value("host");
+    }
+    if (parser.isSet("port")) {
+        config.port = parser.value("port").toInt();
+    }
+    if (parser.isSet("user")) {
+        config.userName = parser.value("user");
+    }
+    if (parser.isSet("fetch-size")) {
+        config.fetchSize = parser.value("fetch-size").toInt();
+    }
+    if (parser.isSet("parallel-workers")) {
+        config.parallelWorkers = parser.value("parallel-workers").toInt();
+    }
+    if (parser.isSet("mmap-size")) {
+        config.mmapSize = parser.value("mmap-size").toLongLong();
+    }
+    if (parser.isSet("cache-size")) {
+        config.cacheSizeKiB = parser.value("cache-size").toLongLong();
+    }
+    if (parser.isSet("temp-store")) {
+        config.tempStoreMemory = parser.value("temp-store").compare("memory", Qt::CaseInsensitive) == 0;
+    }
+    if (parser.isSet("wal")) {
+        config.wal = true;
+    }
+    if (parser.isSet("read-only")) {
+        config.readOnly = true;
+    }
+    if (parser.isSet("immutable")) {
+        config.immutable = true;
+    }
+
+    if (config.dialect == SqlDialect::Sqlite && config.databasePath.isEmpty()) {
+        config.databasePath = defaultDatabasePath();
+    }
+    return config;
+}
+
+bool StorageConfig::loadFile(const QString &fileName)
+{
+    QFileInfo info(fileName);
+    if (!info.exists()) {
+        return false;
+    }
+
+    QSettings settings(fileName, QSettings::IniFormat);
+    settings.beginGroup("storage");
+    if (settings.contains("backend") && !Dialect::fromName(settings.value("backend").toString(), &dialect)) {
+        qDebug() << "Unknown backend:" << settings.value("backend").toString();
+    }
+    if (settings.contains("database")) {
+        QString path = settings.value("database").toString();
+        bool file = dialect == SqlDialect::Sqlite && QDir::isRelativePath(path);
+        databasePath = file ? info.absoluteDir().filePath(path) : path;
+    }
+    host = settings.value("host", host).toString();
+    port = settings.value("port", port).toInt();
+    userName = settings.value("user", userName).toString();
+    password = settings.value("password", password).toString();
+    fetchSize = settings.value("fetch_size", fetchSize).toInt();
+    parallelWorkers = settings.value("parallel_workers", parallelWorkers).toInt();
+    mmapSize = settings.value("mmap_size", mmapSize).toLongLong();
+    cacheSizeKiB = settings.value("cache_size_kib", cacheSizeKiB).toLongLong();
+    tempStoreMemory = settings.value("temp_store", tempStoreMemory ? "memory" : "file").toString()
+                          .compare("memory", Qt::CaseInsensitive) == 0;
+    wal = settings.value("wal", wal).toBool();
+    readOnly = settings.value("read_only", readOnly).toBool();
+    immutable = settings.value("immutable", immutable).toBool();
+    busyTimeoutMs = settings.value("busy_timeout_ms", busyTimeoutMs).toInt();
+    settings.endGroup();
+    return true;
+}
+
+QSqlDatabase StorageConfig::open(const QString &connectionName, QString *error) const
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(Dialect::driverName(dialect), connectionName);
+    if (dialect == SqlDialect::Postgres) {
+        openPostgres(db, error);
+    } else {
+        openSqlite(db, error);
+    }
+    return db;
+}
+
+bool StorageConfig::openSqlite(QSqlDatabase &db, QString *error) const
+{
+    // QSQLITE создал бы на месте отсутствующего файла пустую базу, и все
+    // отчёты молча вернулись бы пустыми
+    if (!QFileInfo(databasePath).isFile()) {
+        if (error) {
+            *error = QString("Database file not found: %1").arg(QDir::toNativeSeparators(databasePath));
+        }
+        return false;
+    }
+
+    QStringList options;
+    options << QString("QSQLITE_BUSY_TIMEOUT=%1").arg(busyTimeoutMs);
+    if (readOnly || immutable) {
+        options << "QSQLITE_OPEN_READONLY";
+    }
+    if (immutable) {
+        // immutable задаётся только параметром URI
+        QUrl url = QUrl::fromLocalFile(QFileInfo(databasePath).absoluteFilePath());
+        url.setQuery("mode=ro&immutable=1");
+        db.setDatabaseName(url.toString());
+        options << "QSQLITE_OPEN_URI";
+    } else {
+        db.setDatabaseName(databasePath);
+    }
+    db.setConnectOptions(options.join(';'));
+
+    if (!db.open()) {
+        if (error) {
+            *error = db.lastError().text();
+        }
+        return false;
+    }
+
+    // Прагмы действуют на соединение; mmap_size ограничивается сверху
+    // сборкой SQLite без сообщения об ошибке
+    QSqlQuery query(db);
+    QStringList pragmas;
+    pragmas << QString("PRAGMA mmap_size=%1").arg(mmapSize);
+    if (cacheSizeKiB > 0) {
+        pragmas << QString("PRAGMA cache_size=-%1").arg(cacheSizeKiB);
+    }
+    if (tempStoreMemory) {
+        pragmas << "PRAGMA temp_store=MEMORY";
+    }
+    for (const QString &pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << "Pragma failed:" << pragma << query.lastError().text();
+        }
+    }
+
+    // Режим журнала хранится в файле, достаточно включить его один раз;
+    // для файла только для чтения он не меняется
+    if (wal && !readOnly && !immutable && query.exec("PRAGMA journal_mode=WAL") && query.next()
+            && query.value(0).toString().compare("wal", Qt::CaseInsensitive) != 0) {
+        qDebug() << "WAL is not available, journal mode:" << query.value(0).toString();
+    }
+    return true;
+}
+
+bool StorageConfig::openPostgres(QSqlDatabase &db, QString *error) const
+{
+    db.setDatabaseName(databasePath);
+    if (!host.isEmpty()) {
+        db.setHostName(host);
+    }
+    if (port > 0) {
+        db.setPort(port);
+    }
+    if (!userName.isEmpty()) {
+        db.setUserName(userName);
+    }
+    if (!password.isEmpty()) {
+        db.setPassword(password);
+    }
+    // Параметры libpq; по имени приложения сеанс виден в pg_stat_activity
+    db.setConnectOptions(QString("connect_timeout=%1;application_name=SalesAnalytics")
+                         .arg(qMax(1, busyTimeoutMs / 1000)));
+
+    if (!db.open()) {
+        if (error) {
+            *error = db.lastError().text();
+        }
+        return false;
+    }
+
+    // Отчёты только читают; параллельность агрегации задаёт сервер, если
+    // число процессов не указано явно
+    QSqlQuery query(db);
+    QStringList settings;
+    if (readOnly || immutable) {
+        settings << "SET default_transaction_read_only = on";
+    }
+    if (parallelWorkers >= 0) {
+        settings << QString("SET max_parallel_workers_per_gather = %1").arg(parallelWorkers);
+    }
+    for (const QString &setting : settings) {
+        if (!query.exec(setting)) {
+            qDebug() << "Session setting failed:" << setting << query.lastError().text();
+        }
+    }
+    return true;
+}
+
+ConnectionPool::ConnectionPool(const StorageConfig &config)
+    : storage(config)
+    , nextId(0)
+{
+}
+
+ConnectionPool::Connection::~Connection()
+{
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+QSqlDatabase ConnectionPool::database(QString *error)
+{
+    if (!connections.hasLocalData()) {
+        QString name = QString("pool-%1-%2").arg(reinterpret_cast<quintptr>(this)).arg(nextId.fetchAndAddRelaxed(1));
+        if (!storage.open(name, error).isOpen()) {
+            QSqlDatabase::removeDatabase(name);
+            return QSqlDatabase();
+        }
+        connections.setLocalData(new Connection{name});
+    }
+    return QSqlDatabase::database(connections.localData()->name, false);
+}
+
+void ConnectionPool::release()
+{
+    if (connections.hasLocalData()) {
+        connections.setLocalData(nullptr);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef STORAGECONFIG_H
+#define STORAGECONFIG_H
+
+#include "sqldialect.h"
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThreadStorage>
+
+class QCommandLineParser;
+
+// Как открывается база: файл SQLite или сервер PostgreSQL. Значения по
+// умолчанию для SQLite рассчитаны на аналитику по большому файлу: страницы
+// читаются через mmap, а не копируются в кэш, временные B-деревья строятся
+// в памяти. WAL включается только явно: режим журнала сохраняется в самом
+// файле базы, а рядом с ним появляются файлы -wal и -shm. В режиме только
+// для чтения агрегаты rollup_* и индексы не создаются, отчёты идут по
+// исходным таблицам. Для PostgreSQL прагмы не применяются, а отчёты
+// считает сервер
+struct StorageConfig
+{
+    SqlDialect dialect;
+    QString databasePath;  // файл SQLite или имя базы PostgreSQL; пусто — chinook.db рядом с программой,
+                           // в рабочем каталоге или в каталоге исходников
+    qint64 mmapSize;       // байт; 0 — без отображения в память
+    qint64 cacheSizeKiB;   // кэш страниц на соединение
+    bool tempStoreMemory;
+    bool wal;
+    bool readOnly;
+    bool immutable;        // файл никто не меняет: без блокировок и проверки изменений
+    int busyTimeoutMs;
+
+    // PostgreSQL. Пустые значения берутся libpq из PGHOST, PGUSER,
+    // PGPASSWORD и т. д.; пароль задаётся только в файле или окружении
+    QString host;
+    int port;
+    QString userName;
+    QString password;
+    int fetchSize;         // строк на FETCH из курсора на сервере
+    int parallelWorkers;   // max_parallel_workers_per_gather; < 0 — как на сервере
+
+    StorageConfig();
+
+    // Ключи --config, --backend, --db, --host, --port, --user, --fetch-size,
+    // --parallel-workers, --mmap-size, --cache-size, --temp-store,
+    // --wal, --read-only, --immutable
+    static void addOptions(QCommandLineParser *parser);
+
+    // Значения по умолчанию, поверх них файл настроек (--config или
+    // salesanalytics.ini рядом с программой), поверх — ключи командной строки
+    static StorageConfig fromParser(const QCommandLineParser &parser);
+
+    // Секция [storage] INI-файла; относительный путь к базе — от файла
+    bool loadFile(const QString &fileName);
+
+    // Регистрирует соединение, открывает его и применяет прагмы или
+    // параметры сеанса. При ошибке соединение остаётся зарегистрированным
+    // и закрытым
+    QSqlDatabase open(const QString &connectionName, QString *error = nullptr) const;
+
+private:
+    bool openSqlite(QSqlDatabase &db, QString *error) const;
+    bool openPostgres(QSqlDatabase &db, QString *error) const;
+};
+
+// Соединения с одной базой по одному на поток. Соединение открывается при
+// первом обращении из потока и закрывается при его завершении, поэтому
+// потоки пула не открывают базу и не прогревают кэш заново на каждую задачу
+class ConnectionPool
+{
+public:
+    explicit ConnectionPool(const StorageConfig &config);
+
+    const StorageConfig &config() const { return storage; }
+
+    // Соединение текущего потока; закрытое при ошибке открытия
+    QSqlDatabase database(QString *error = nullptr);
+
+    // Закрывает соединение текущего потока раньше его завершения
+    void release();
+
+private:
+    struct Connection
+    {
+        QString name;
+        ~Connection();
+    };
+
+    StorageConfig storage;
+    QAtomicInt nextId;
+    QThreadStorage<Connection *> connections;
+};
+
+typedef QSharedPointer<ConnectionPool> ConnectionPoolPtr;
+
+#endif // STORAGECONFIG_H
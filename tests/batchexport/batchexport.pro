@@ -0,0 +1,34 @@
+# Пакетная выгрузка отчётов с фильтрами и подстановка параметров в SQL
+
+QT       += testlib sql
+QT       -= gui
+
+TARGET = tst_batchexport
+TEMPLATE = app
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        tst_batchexport.cpp \
+        ../../batchexport.cpp \
+        ../../exportwriters.cpp \
+        ../../reports.cpp \
+        ../../queryresult.cpp \
+        ../../sqldialect.cpp \
+        ../../statementregistry.cpp \
+        ../../servercursor.cpp \
+        ../../storageconfig.cpp \
+        ../../tracing.cpp
+
+HEADERS += \
+    ../../batchexport.h \
+    ../../exportwriters.h \
+    ../../reports.h \
+    ../../queryresult.h \
+    ../../sqldialect.h \
+    ../../statementregistry.h \
+    ../../servercursor.h \
+    ../../storageconfig.h \
+    ../../tracing.h
@@ -0,0 +1,170 @@
+#include "batchexport.h"
+#include "reports.h"
+#include "sqldialect.h"
+#include "statementregistry.h"
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+
+// Маленькая база в схеме chinook: два жанра, два артиста, счета из двух
+// стран и без страны, трек без жанра
+static const char *const fixture[] = {
+    "CREATE TABLE genres (GenreId INTEGER PRIMARY KEY, Name TEXT)",
+    "CREATE TABLE artists (ArtistId INTEGER PRIMARY KEY, Name TEXT)",
+    "CREATE TABLE albums (AlbumId INTEGER PRIMARY KEY, ArtistId INTEGER)",
+    "CREATE TABLE tracks (TrackId INTEGER PRIMARY KEY, AlbumId INTEGER, GenreId INTEGER)",
+    "CREATE TABLE invoices (InvoiceId INTEGER PRIMARY KEY, InvoiceDate TEXT, BillingCountry TEXT, BillingCity TEXT)",
+    "CREATE TABLE invoice_items (InvoiceLineId INTEGER PRIMARY KEY, InvoiceId INTEGER, TrackId INTEGER,"
+    " UnitPrice REAL, Quantity INTEGER)",
+    "INSERT INTO genres VALUES (1, 'Rock'), (2, 'Jazz')",
+    "INSERT INTO artists VALUES (1, 'Alpha'), (2, 'Beta')",
+    "INSERT INTO albums VALUES (1, 1), (2, 2)",
+    "INSERT INTO tracks VALUES (1, 1, 1), (2, 2, 2), (3, 1, 2), (4, 2, NULL)",
+    "INSERT INTO invoices VALUES (1, '2020-01-05 00:00:00', 'USA', 'Boston'),"
+    " (2, '2020-02-10 00:00:00', 'Canada', 'Ottawa'), (3, '2020-02-11 00:00:00', NULL, NULL)",
+    "INSERT INTO invoice_items VALUES (1, 1, 1, 0.99, 2), (2, 1, 2, 0.99, 1), (3, 2, 3, 0.99, 3),"
+    " (4, 3, 2, 0.99, 4), (5, 2, 4, 0.99, 1)"
+};
+
+static QList<QStringList> readRows(QSqlQuery &query)
+{
+    QList<QStringList> rows;
+    while (query.next()) {
+        QStringList row;
+        for (int col = 0; col < query.record().count(); ++col) {
+            row << query.value(col).toString();
+        }
+        rows << row;
+    }
+    return rows;
+}
+
+class TestBatchExport : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void inlineEveryOccurrence();
+    void inlinedReportsMatchBound_data();
+    void inlinedReportsMatchBound();
+    void exportFilteredReport_data();
+    void exportFilteredReport();
+
+private:
+    QTemporaryDir directory;
+    QString databasePath;
+};
+
+void TestBatchExport::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    databasePath = directory.filePath("fixture.db");
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "fixture");
+    db.setDatabaseName(databasePath);
+    QVERIFY(db.open());
+    QSqlQuery query(db);
+    for (const char *statement : fixture) {
+        QVERIFY2(query.exec(statement), statement);
+    }
+}
+
+void TestBatchExport::cleanupTestCase()
+{
+    QSqlDatabase::database("fixture").close();
+    QSqlDatabase::removeDatabase("fixture");
+}
+
+void TestBatchExport::inlineEveryOccurrence()
+{
+    QVariantMap params;
+    params.insert(":genreId", 2);
+    params.insert(":genreIdList", "1,2");
+    QVariantMap defaults;
+    defaults.insert(":country", QVariant(QVariant::String));
+
+    QString sql = "SELECT :genreIdList, ':genreId', x::genreId, "
+                  "(CAST(:genreId AS INTEGER) IS NULL OR g = :genreId) AND c = :country";
+    QCOMPARE(Dialect::inlineParams(QSqlDatabase::database("fixture"), sql, params, defaults),
+             QString("SELECT '1,2', ':genreId', x::genreId, "
+                     "(CAST(2 AS INTEGER) IS NULL OR g = 2) AND c = NULL"));
+}
+
+void TestBatchExport::inlinedReportsMatchBound_data()
+{
+    QTest::addColumn<QString>("country");
+    QTest::addColumn<QVariant>("genreId");
+
+    QTest::newRow("no filter") << QString() << QVariant();
+    QTest::newRow("genre") << QString() << QVariant(2);
+    QTest::newRow("country") << QString("USA") << QVariant();
+    QTest::newRow("country and genre") << QString("USA") << QVariant(2);
+}
+
+void TestBatchExport::inlinedReportsMatchBound()
+{
+    // Курсор PostgreSQL получает параметры подставленными в текст; на
+    // SQLite тот же текст должен давать те же строки, что и привязка
+    QFETCH(QString, country);
+    QFETCH(QVariant, genreId);
+    QVariantMap params;
+    if (!country.isEmpty()) {
+        params.insert(":country", country);
+    }
+    if (genreId.isValid()) {
+        params.insert(":genreId", genreId);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database("fixture");
+    for (const ReportDefinition &report : Reports::all()) {
+        StatementRegistry statements;
+        QSqlQuery bound(db);
+        QVERIFY(statements.prepare(db, report.name, report.sql));
+        QVERIFY(statements.exec(report.name, params, Reports::defaultParams(), &bound));
+        QList<QStringList> expected = readRows(bound);
+
+        QSqlQuery inlined(db);
+        QVERIFY2(inlined.exec(Dialect::inlineParams(db, report.sql, params, Reports::defaultParams())),
+                 qPrintable(report.name));
+        QCOMPARE(readRows(inlined), expected);
+    }
+}
+
+void TestBatchExport::exportFilteredReport_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("genre")
+        << (QStringList() << "--report" << "artists-by-genre" << "--param" << "genreId=2")
+        << QString("GenreName,ArtistName,TotalSales\r\nJazz,Beta,5\r\nJazz,Alpha,3\r\n");
+    QTest::newRow("country and genre")
+        << (QStringList() << "--report" << "artists-by-genre" << "--param" << "genreId=2"
+                          << "--param" << "country=USA")
+        << QString("GenreName,ArtistName,TotalSales\r\nJazz,Beta,1\r\n");
+    QTest::newRow("country, all genres")
+        << (QStringList() << "--report" << "sales-by-city" << "--param" << "country=Canada")
+        << QString("BillingCountry,BillingCity,TotalQuantity,TotalSales\r\nCanada,Ottawa,4,3.96\r\n");
+}
+
+void TestBatchExport::exportFilteredReport()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QString, expected);
+
+    QString output = directory.filePath("report.csv");
+    QStringList command;
+    command << "tst_batchexport" << arguments << "--format" << "csv" << "--out" << output << "--db" << databasePath;
+    QCOMPARE(BatchExport::run(command), 0);
+
+    QFile file(output);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(QString::fromUtf8(file.readAll()), expected);
+}
+
+QTEST_GUILESS_MAIN(TestBatchExport)
+
+#include "tst_batchexport.moc"
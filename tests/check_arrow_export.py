@@ -0,0 +1,90 @@
+# Проверка выгрузки Arrow: каждый отчёт выгружается в Arrow IPC и в CSV,
+# поток Arrow читается pyarrow и сверяется с CSV по столбцам, числу строк,
+# типам и значениям:
+#   python3 tests/check_arrow_export.py путь/к/SalesAnalytics [ключи хранилища]
+# Например: ... ./SalesAnalytics --db chinook.db
+import csv
+import io
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+import pyarrow as pa
+import pyarrow.ipc as ipc
+
+
+USAGE = "usage: check_arrow_export.py SalesAnalytics [storage options]"
+
+
+def run(app, args):
+    result = subprocess.run([app] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    if result.returncode != 0:
+        raise RuntimeError("%s failed: %s" % (" ".join(args), result.stderr.decode(errors="replace")))
+    return result.stdout
+
+
+def same(value, text, arrow_type):
+    # NULL пишется в CSV пустым полем
+    if value is None:
+        return text == ""
+    if pa.types.is_integer(arrow_type):
+        return text != "" and int(text) == value
+    if pa.types.is_floating(arrow_type):
+        return text != "" and math.isclose(float(text), value, rel_tol=1e-12, abs_tol=1e-9)
+    return text == value
+
+
+def check_report(app, storage, report, directory):
+    arrow_file = os.path.join(directory, report + ".arrow")
+    run(app, ["--report", report, "--format", "arrow", "--out", arrow_file] + storage)
+    csv_text = run(app, ["--report", report, "--format", "csv"] + storage).decode("utf-8")
+
+    with pa.OSFile(arrow_file, "rb") as source:
+        table = ipc.open_stream(source).read_all()
+    rows = list(csv.reader(io.StringIO(csv_text, newline="")))
+    header, rows = rows[0], rows[1:]
+
+    errors = []
+    if table.column_names != header:
+        errors.append("columns %s != %s" % (table.column_names, header))
+    if table.num_rows != len(rows):
+        errors.append("%d rows in Arrow, %d in CSV" % (table.num_rows, len(rows)))
+    for col, field in enumerate(table.schema):
+        if not (pa.types.is_int64(field.type) or pa.types.is_float64(field.type) or pa.types.is_string(field.type)):
+            errors.append("column %s has unexpected type %s" % (field.name, field.type))
+        values = table.column(col).to_pylist()
+        for row, (value, line) in enumerate(zip(values, rows)):
+            if not same(value, line[col], field.type):
+                errors.append("row %d, column %s: %r in Arrow, %r in CSV" % (row, field.name, value, line[col]))
+                break
+    return table, errors
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(USAGE, file=sys.stderr)
+        return 2
+    app, storage = sys.argv[1], sys.argv[2:]
+    reports = run(app, ["--list-reports"]).decode("utf-8").split()
+
+    failed = 0
+    with tempfile.TemporaryDirectory() as directory:
+        for report in reports:
+            try:
+                table, errors = check_report(app, storage, report, directory)
+            except Exception as error:  # noqa: BLE001 — любая ошибка отчёта идёт в итог
+                table, errors = None, [str(error)]
+            if errors:
+                failed += 1
+                print("FAIL %s" % report)
+                for error in errors:
+                    print("    " + error)
+            else:
+                print("ok   %s: %d rows, %s" % (report, table.num_rows, table.schema.types))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,18 @@
+# Прореживание рядов: LTTB и огибающая min/max
+
+QT       += testlib
+QT       -= gui
+
+TARGET = tst_downsampling
+TEMPLATE = app
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        tst_downsampling.cpp \
+        ../../downsampling.cpp
+
+HEADERS += \
+    ../../downsampling.h
@@ -0,0 +1,148 @@
+#include "downsampling.h"
+#include <QtTest>
+#include <cmath>
+
+using namespace Downsampling;
+
+// Зашумлённая синусоида с одним выбросом вверх и одним вниз
+static QVector<QPointF> noisySeries(int count)
+{
+    QVector<QPointF> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double y = std::sin(i / 50.0) * 100 + (i * 7919 % 13) - 6;
+        points.append(QPointF(i, y));
+    }
+    points[count / 3].setY(1000);
+    points[2 * count / 3].setY(-1000);
+    return points;
+}
+
+// Результат — упорядоченное подмножество исходного ряда с теми же краями
+static bool isOrderedSubset(const QVector<QPointF> &sampled, const QVector<QPointF> &points)
+{
+    if (sampled.isEmpty() || sampled.first() != points.first() || sampled.last() != points.last()) {
+        return false;
+    }
+    int from = 0;
+    for (const QPointF &point : sampled) {
+        while (from < points.size() && points[from] != point) {
+            ++from;
+        }
+        if (from == points.size()) {
+            return false;
+        }
+        ++from;
+    }
+    return true;
+}
+
+class TestDownsampling : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void shortSeriesUnchanged_data();
+    void shortSeriesUnchanged();
+    void smallThresholdKeepsEnds_data();
+    void smallThresholdKeepsEnds();
+    void lttbThresholdThree();
+    void lttbKeepsShape();
+    void minMaxKeepsPeaks();
+    void window();
+};
+
+void TestDownsampling::shortSeriesUnchanged_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("threshold");
+
+    QTest::newRow("lttb, empty") << int(Method::Lttb) << 0 << 10;
+    QTest::newRow("lttb, fewer points") << int(Method::Lttb) << 5 << 10;
+    QTest::newRow("lttb, equal") << int(Method::Lttb) << 10 << 10;
+    QTest::newRow("lttb, threshold 1") << int(Method::Lttb) << 10 << 1;
+    QTest::newRow("minmax, empty") << int(Method::MinMax) << 0 << 10;
+    QTest::newRow("minmax, fewer points") << int(Method::MinMax) << 5 << 10;
+    QTest::newRow("minmax, equal") << int(Method::MinMax) << 10 << 10;
+    QTest::newRow("minmax, threshold 0") << int(Method::MinMax) << 10 << 0;
+}
+
+void TestDownsampling::shortSeriesUnchanged()
+{
+    QFETCH(int, method);
+    QFETCH(int, count);
+    QFETCH(int, threshold);
+
+    QVector<QPointF> points = noisySeries(qMax(count, 3)).mid(0, count);
+    QCOMPARE(downsample(Method(method), points, threshold), points);
+}
+
+void TestDownsampling::smallThresholdKeepsEnds_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("threshold");
+
+    QTest::newRow("lttb, 2") << int(Method::Lttb) << 2;
+    QTest::newRow("minmax, 2") << int(Method::MinMax) << 2;
+    QTest::newRow("minmax, 3") << int(Method::MinMax) << 3;
+}
+
+void TestDownsampling::smallThresholdKeepsEnds()
+{
+    QFETCH(int, method);
+    QFETCH(int, threshold);
+
+    QVector<QPointF> points = noisySeries(100);
+    QVector<QPointF> sampled = downsample(Method(method), points, threshold);
+    QCOMPARE(sampled, QVector<QPointF>() << points.first() << points.last());
+}
+
+void TestDownsampling::lttbThresholdThree()
+{
+    // Одна корзина: остаётся точка с наибольшим треугольником
+    QVector<QPointF> points;
+    points << QPointF(0, 0) << QPointF(1, 1) << QPointF(2, 10) << QPointF(3, 2) << QPointF(4, 0);
+    QVector<QPointF> sampled = lttb(points, 3);
+    QCOMPARE(sampled, QVector<QPointF>() << QPointF(0, 0) << QPointF(2, 10) << QPointF(4, 0));
+}
+
+void TestDownsampling::lttbKeepsShape()
+{
+    QVector<QPointF> points = noisySeries(10000);
+    QVector<QPointF> sampled = lttb(points, 200);
+    QCOMPARE(sampled.size(), 200);
+    QVERIFY(isOrderedSubset(sampled, points));
+    QVERIFY(sampled.contains(points[points.size() / 3]));
+    QVERIFY(sampled.contains(points[2 * points.size() / 3]));
+}
+
+void TestDownsampling::minMaxKeepsPeaks()
+{
+    QVector<QPointF> points = noisySeries(10000);
+    for (int threshold : {4, 5, 200, 9999}) {
+        QVector<QPointF> sampled = minMax(points, threshold);
+        QVERIFY(sampled.size() <= threshold);
+        QVERIFY(isOrderedSubset(sampled, points));
+        QVERIFY(sampled.contains(points[points.size() / 3]));
+        QVERIFY(sampled.contains(points[2 * points.size() / 3]));
+    }
+}
+
+void TestDownsampling::window()
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < 10; ++i) {
+        points.append(QPointF(i, i * i));
+    }
+    // По соседней точке с каждой стороны окна
+    QCOMPARE(Downsampling::window(points, 3.5, 5.5), points.mid(3, 4));
+    QCOMPARE(Downsampling::window(points, 3, 5), points.mid(2, 5));
+    QCOMPARE(Downsampling::window(points, -5, 100), points);
+    QCOMPARE(Downsampling::window(points, 20, 30), points.mid(9, 1));
+    QCOMPARE(Downsampling::window(QVector<QPointF>(), 0, 1), QVector<QPointF>());
+}
+
+QTEST_APPLESS_MAIN(TestDownsampling)
+
+#include "tst_downsampling.moc"
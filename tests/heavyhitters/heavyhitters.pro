@@ -0,0 +1,18 @@
+# Частые элементы: Space-Saving и Count-Min
+
+QT       += testlib
+QT       -= gui
+
+TARGET = tst_heavyhitters
+TEMPLATE = app
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        tst_heavyhitters.cpp \
+        ../../heavyhitters.cpp
+
+HEADERS += \
+    ../../heavyhitters.h
@@ -0,0 +1,178 @@
+#include "heavyhitters.h"
+#include <QtTest>
+
+// Поток с перекосом: ключ k встречается примерно в 1/k раз реже первого
+static QVector<quint64> skewedStream(int length, int keys)
+{
+    QVector<quint64> stream;
+    stream.reserve(length);
+    quint64 state = 12345;
+    for (int i = 0; i < length; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        double unit = double(state >> 11) / double(1ull << 53);
+        stream.append(quint64(1 + (keys - 1) * unit * unit * unit));
+    }
+    return stream;
+}
+
+static QHash<quint64, qint64> exactCounts(const QVector<quint64> &stream)
+{
+    QHash<quint64, qint64> counts;
+    for (quint64 key : stream) {
+        ++counts[key];
+    }
+    return counts;
+}
+
+class TestHeavyHitters : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void exactUnderCapacity();
+    void evictionInheritsError();
+    void errorBounds();
+    void tiesAtTopBoundary();
+    void topLongerThanCounters();
+    void countMinBounds();
+    void clear();
+};
+
+void TestHeavyHitters::exactUnderCapacity()
+{
+    SpaceSaving counters(8);
+    counters.add(3, 5);
+    counters.add(1);
+    counters.add(3, 2);
+    counters.add(7, 4);
+
+    QVector<SpaceSaving::Counter> top = counters.top(8);
+    QCOMPARE(top.size(), 3);
+    QCOMPARE(top[0].key, quint64(3));
+    QCOMPARE(top[0].count, qint64(7));
+    QCOMPARE(top[1].key, quint64(7));
+    QCOMPARE(top[2].key, quint64(1));
+    for (const SpaceSaving::Counter &counter : top) {
+        QCOMPARE(counter.error, qint64(0));
+    }
+    QCOMPARE(counters.total(), qint64(12));
+    QCOMPARE(counters.maxError(), qint64(0));
+}
+
+void TestHeavyHitters::evictionInheritsError()
+{
+    SpaceSaving counters(2);
+    counters.add(1, 5);
+    counters.add(2, 3);
+    counters.add(3, 1);
+
+    // Вытеснен минимальный ключ 2, новый ключ наследует его значение
+    QVector<SpaceSaving::Counter> top = counters.top(2);
+    QCOMPARE(top.size(), 2);
+    QCOMPARE(top[0].key, quint64(1));
+    QCOMPARE(top[1].key, quint64(3));
+    QCOMPARE(top[1].count, qint64(4));
+    QCOMPARE(top[1].error, qint64(3));
+    QCOMPARE(counters.maxError(), qint64(4));
+}
+
+void TestHeavyHitters::errorBounds()
+{
+    QVector<quint64> stream = skewedStream(20000, 500);
+    QHash<quint64, qint64> exact = exactCounts(stream);
+    SpaceSaving counters(32);
+    for (quint64 key : stream) {
+        counters.add(key);
+    }
+    QCOMPARE(counters.total(), qint64(stream.size()));
+
+    QVector<SpaceSaving::Counter> top = counters.top(counters.capacity());
+    QCOMPARE(top.size(), counters.capacity());
+    QSet<quint64> present;
+    for (const SpaceSaving::Counter &counter : top) {
+        qint64 actual = exact.value(counter.key);
+        QVERIFY(counter.count - counter.error <= actual);
+        QVERIFY(actual <= counter.count);
+        QVERIFY(counter.error <= counters.maxError());
+        present.insert(counter.key);
+    }
+    // Всё, что чаще total / capacity, обязано остаться
+    for (auto it = exact.constBegin(); it != exact.constEnd(); ++it) {
+        if (it.value() > counters.total() / counters.capacity()) {
+            QVERIFY(present.contains(it.key()));
+        }
+    }
+}
+
+void TestHeavyHitters::tiesAtTopBoundary()
+{
+    // Три ключа делят второе место; порядок вставки разный, ответ один
+    QVector<QVector<quint64>> orders;
+    orders << QVector<quint64>{5, 4, 3, 1, 2} << QVector<quint64>{2, 1, 3, 4, 5}
+           << QVector<quint64>{3, 2, 5, 1, 4};
+    for (const QVector<quint64> &order : orders) {
+        SpaceSaving counters(8);
+        for (quint64 key : order) {
+            counters.add(key, key == 5 ? 10 : key == 2 ? 1 : 7);
+        }
+        QVector<SpaceSaving::Counter> top = counters.top(3);
+        QCOMPARE(top.size(), 3);
+        QCOMPARE(top[0].key, quint64(5));
+        QCOMPARE(top[1].key, quint64(1));
+        QCOMPARE(top[2].key, quint64(3));
+        QCOMPARE(top[2].count, qint64(7));
+    }
+}
+
+void TestHeavyHitters::topLongerThanCounters()
+{
+    SpaceSaving counters(4);
+    QVERIFY(counters.top(3).isEmpty());
+    counters.add(1);
+    counters.add(2);
+    QCOMPARE(counters.top(10).size(), 2);
+    QVERIFY(counters.top(0).isEmpty());
+}
+
+void TestHeavyHitters::countMinBounds()
+{
+    QVector<quint64> stream = skewedStream(20000, 2000);
+    QHash<quint64, qint64> exact = exactCounts(stream);
+    CountMinSketch sketch(256, 4);
+    for (quint64 key : stream) {
+        sketch.add(key);
+    }
+    QCOMPARE(sketch.total(), qint64(stream.size()));
+
+    // Оценка не меньше истинной всегда, превышает границу редко
+    int outside = 0;
+    for (auto it = exact.constBegin(); it != exact.constEnd(); ++it) {
+        qint64 estimate = sketch.estimate(it.key());
+        QVERIFY(estimate >= it.value());
+        if (estimate > it.value() + sketch.errorBound()) {
+            ++outside;
+        }
+    }
+    QVERIFY(outside <= exact.size() / 20);
+}
+
+void TestHeavyHitters::clear()
+{
+    SpaceSaving counters(2);
+    CountMinSketch sketch(16, 2);
+    for (quint64 key = 1; key <= 5; ++key) {
+        counters.add(key, 3);
+        sketch.add(key, 3);
+    }
+    counters.clear();
+    sketch.clear();
+    QVERIFY(counters.top(2).isEmpty());
+    QCOMPARE(counters.total(), qint64(0));
+    QCOMPARE(counters.maxError(), qint64(0));
+    QCOMPARE(sketch.total(), qint64(0));
+    QCOMPARE(sketch.estimate(3), qint64(0));
+}
+
+QTEST_APPLESS_MAIN(TestHeavyHitters)
+
+#include "tst_heavyhitters.moc"
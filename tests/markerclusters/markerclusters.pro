@@ -0,0 +1,18 @@
+# Кластеризация маркеров карты по сетке
+
+QT       += testlib
+QT       -= gui
+
+TARGET = tst_markerclusters
+TEMPLATE = app
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        tst_markerclusters.cpp \
+        ../../markerclusters.cpp
+
+HEADERS += \
+    ../../markerclusters.h
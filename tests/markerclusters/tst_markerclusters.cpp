@@ -0,0 +1,138 @@
+#include "markerclusters.h"
+#include <QtTest>
+
+static MarkerClusters::Point point(qreal x, qreal y, double value)
+{
+    return MarkerClusters::Point{QPointF(x, y), value, QString()};
+}
+
+class TestMarkerClusters : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyInput();
+    void singlePoint();
+    void mergesNeighbours();
+    void zeroValuesUsePointCount();
+    void levelsConserveTotals();
+    void levelForScale();
+};
+
+void TestMarkerClusters::emptyInput()
+{
+    MarkerClusters clusters;
+    clusters.build(QVector<MarkerClusters::Point>(), 2);
+    QCOMPARE(clusters.levelCount(), 1);
+    QCOMPARE(clusters.nodeCount(), 0);
+    QCOMPARE(clusters.levelBegin(0), 0);
+    QCOMPARE(clusters.levelEnd(0), 0);
+    QCOMPARE(clusters.levelForScale(1, 10), 0);
+    QCOMPARE(clusters.levelForScale(0.001, 10), 0);
+    QCOMPARE(clusters.levelForScale(0, 10), 0);
+}
+
+void TestMarkerClusters::singlePoint()
+{
+    MarkerClusters clusters;
+    clusters.build(QVector<MarkerClusters::Point>() << point(5, 7, 3), 2);
+    QCOMPARE(clusters.levelCount(), 1);
+    QCOMPARE(clusters.nodeCount(), 1);
+    QCOMPARE(clusters.position(0), QPointF(5, 7));
+    QCOMPARE(clusters.parent(0), -1);
+    QCOMPARE(clusters.levelForScale(0.001, 10), 0);
+}
+
+void TestMarkerClusters::mergesNeighbours()
+{
+    MarkerClusters clusters;
+    clusters.build(QVector<MarkerClusters::Point>() << point(0, 0, 1) << point(1, 0, 3) << point(100, 0, 2), 2);
+
+    // Уровень 1 (радиус 2): первые две точки сливаются, третья одна
+    QCOMPARE(clusters.levelEnd(1) - clusters.levelBegin(1), 2);
+    int pair = clusters.parent(0);
+    QCOMPARE(clusters.parent(1), pair);
+    QVERIFY(clusters.parent(2) != pair);
+    QCOMPARE(clusters.value(pair), 4.0);
+    QCOMPARE(clusters.pointCount(pair), 2);
+    QCOMPARE(clusters.leader(pair), 1);
+    QCOMPARE(clusters.position(pair), QPointF(0.75, 0));
+
+    // Дальняя точка присоединяется, когда радиус дорастает до 128
+    QCOMPARE(clusters.levelCount(), 8);
+    QCOMPARE(clusters.radius(7), 128.0);
+    int top = clusters.levelBegin(7);
+    QCOMPARE(clusters.levelEnd(7), top + 1);
+    QCOMPARE(clusters.value(top), 6.0);
+    QCOMPARE(clusters.pointCount(top), 3);
+    QCOMPARE(clusters.leader(top), 1);
+    QCOMPARE(clusters.parent(top), -1);
+}
+
+void TestMarkerClusters::zeroValuesUsePointCount()
+{
+    MarkerClusters clusters;
+    clusters.build(QVector<MarkerClusters::Point>() << point(0, 0, 0) << point(1, 1, 0), 2);
+    QCOMPARE(clusters.levelCount(), 2);
+    int top = clusters.levelBegin(1);
+    QCOMPARE(clusters.position(top), QPointF(0.5, 0.5));
+    QCOMPARE(clusters.value(top), 0.0);
+}
+
+void TestMarkerClusters::levelsConserveTotals()
+{
+    QVector<MarkerClusters::Point> points;
+    double total = 0;
+    quint32 state = 1;
+    for (int i = 0; i < 2000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        qreal x = (state >> 8) % 10000 / 10.0;
+        state = state * 1664525u + 1013904223u;
+        qreal y = (state >> 8) % 5000 / 10.0;
+        points.append(point(x, y, i % 17));
+        total += i % 17;
+    }
+    MarkerClusters clusters;
+    clusters.build(points, 1);
+
+    int top = clusters.levelCount() - 1;
+    QCOMPARE(clusters.levelEnd(top) - clusters.levelBegin(top), 1);
+    for (int level = 0; level <= top; ++level) {
+        double sum = 0;
+        int count = 0;
+        for (int node = clusters.levelBegin(level); node < clusters.levelEnd(level); ++node) {
+            sum += clusters.value(node);
+            count += clusters.pointCount(node);
+            // Родитель лежит на следующем уровне и включает значение узла
+            int parent = clusters.parent(node);
+            if (level == top) {
+                QCOMPARE(parent, -1);
+                continue;
+            }
+            QVERIFY(parent >= clusters.levelBegin(level + 1) && parent < clusters.levelEnd(level + 1));
+            QVERIFY(clusters.value(parent) >= clusters.value(node));
+        }
+        QCOMPARE(sum, total);
+        QCOMPARE(count, points.size());
+    }
+}
+
+void TestMarkerClusters::levelForScale()
+{
+    MarkerClusters clusters;
+    clusters.build(QVector<MarkerClusters::Point>() << point(0, 0, 1) << point(1, 0, 3) << point(100, 0, 2), 2);
+    QCOMPARE(clusters.levelCount(), 8);
+
+    // Нужный радиус в единицах сцены — pixelRadius / scale
+    QCOMPARE(clusters.levelForScale(10, 10), 0);
+    QCOMPARE(clusters.levelForScale(5, 10), 0);
+    QCOMPARE(clusters.levelForScale(10, 30), 2);
+    QCOMPARE(clusters.levelForScale(1, 64), 6);
+    QCOMPARE(clusters.levelForScale(1, 65), 7);
+    QCOMPARE(clusters.levelForScale(0.001, 10), 7);
+    QCOMPARE(clusters.levelForScale(0, 10), 7);
+}
+
+QTEST_APPLESS_MAIN(TestMarkerClusters)
+
+#include "tst_markerclusters.moc"
@@ -0,0 +1,10 @@
+# Модульные тесты без окон; база — временный файл SQLite:
+#   qmake tests.pro && make && make check
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    batchexport \
+    downsampling \
+    heavyhitters \
+    markerclusters
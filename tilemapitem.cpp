@@ -0,0 +1,98 @@
+#include "tilemapitem.h"
+#include <QPainter>
+#include <QPixmapCache>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+
+namespace
+{
+
+int nextCacheId = 0;
+
+} // namespace
+
+TileMapItem::TileMapItem(const QImage &image, const QSizeF &sceneSize, QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , size(sceneSize)
+    , cacheId(++nextCacheId)
+{
+    // Нужна открытая область в option->exposedRect
+    setFlag(ItemUsesExtendedStyleOption);
+
+    if (image.isNull()) {
+        return;
+    }
+    levels.append(image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    while (levels.last().width() > TileSize || levels.last().height() > TileSize) {
+        const QImage &previous = levels.last();
+        levels.append(previous.scaled(qMax(1, previous.width() / 2), qMax(1, previous.height() / 2),
+                                      Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    }
+}
+
+QRectF TileMapItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), size);
+}
+
+int TileMapItem::levelForScale(qreal devicePixelsPerSceneUnit) const
+{
+    if (levels.isEmpty() || devicePixelsPerSceneUnit <= 0) {
+        return 0;
+    }
+    // Сколько пикселей экрана приходится на пиксель уровня 0
+    qreal devicePixelsPerImagePixel = devicePixelsPerSceneUnit * size.width() / levels.first().width();
+    int level = int(std::floor(std::log2(1.0 / devicePixelsPerImagePixel)));
+    return qBound(0, level, levels.size() - 1);
+}
+
+QPixmap TileMapItem::tile(int level, int column, int row) const
+{
+    QString key = QString("tile-%1-%2-%3-%4").arg(cacheId).arg(level).arg(column).arg(row);
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        const QImage &image = levels.at(level);
+        QRect source(column * TileSize, row * TileSize, TileSize, TileSize);
+        pixmap = QPixmap::fromImage(image.copy(source & image.rect()));
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
+}
+
+void TileMapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    paintTiles(painter, option->exposedRect);
+}
+
+void TileMapItem::paintTiles(QPainter *painter, const QRectF &exposedRect) const
+{
+    if (levels.isEmpty()) {
+        return;
+    }
+
+    int level = levelForScale(QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()));
+    const QImage &image = levels.at(level);
+
+    // Размер пикселя уровня в координатах сцены
+    qreal unitX = size.width() / image.width();
+    qreal unitY = size.height() / image.height();
+    qreal tileWidth = TileSize * unitX;
+    qreal tileHeight = TileSize * unitY;
+
+    int columns = (image.width() + TileSize - 1) / TileSize;
+    int rows = (image.height() + TileSize - 1) / TileSize;
+    QRectF exposed = exposedRect & boundingRect();
+    int firstColumn = qBound(0, int(exposed.left() / tileWidth), columns - 1);
+    int lastColumn = qBound(0, int(std::ceil(exposed.right() / tileWidth)) - 1, columns - 1);
+    int firstRow = qBound(0, int(exposed.top() / tileHeight), rows - 1);
+    int lastRow = qBound(0, int(std::ceil(exposed.bottom() / tileHeight)) - 1, rows - 1);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            QPixmap pixmap = tile(level, column, row);
+            QRectF target(column * tileWidth, row * tileHeight, pixmap.width() * unitX, pixmap.height() * unitY);
+            painter->drawPixmap(target, pixmap, QRectF(pixmap.rect()));
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TILEMAPITEM_H
+#define TILEMAPITEM_H
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+
+// Фоновая карта в виде пирамиды тайлов. Уровень 0 — исходное изображение,
+// каждый следующий вдвое меньше. При отрисовке выбирается уровень, близкий
+// к одному пикселю изображения на пиксель экрана, и рисуются только тайлы,
+// попавшие в открытую область. Тайлы переводятся в QPixmap по требованию
+// и хранятся в QPixmapCache, поэтому исходная карта может быть намного
+// подробнее сцены без роста затрат на кадр
+class TileMapItem : public QGraphicsItem
+{
+public:
+    static const int TileSize = 256;
+
+    // sceneSize — размер карты в координатах сцены (в них заданы маркеры)
+    TileMapItem(const QImage &image, const QSizeF &sceneSize, QGraphicsItem *parent = nullptr);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+    // Тайлы, попавшие в exposed (координаты элемента); уровень — по
+    // преобразованию painter. Так карту рисует и фон сцены
+    void paintTiles(QPainter *painter, const QRectF &exposed) const;
+
+    int levelCount() const { return levels.size(); }
+    int levelForScale(qreal devicePixelsPerSceneUnit) const;
+
+private:
+    QPixmap tile(int level, int column, int row) const;
+
+    QVector<QImage> levels;
+    QSizeF size;
+    int cacheId;
+};
+
+#endif // TILEMAPITEM_H
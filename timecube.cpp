@@ -0,0 +1,148 @@
+#include "timecube.h"
+#include "servercursor.h"
+#include "sqldialect.h"
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+
+namespace
+{
+
+// Те же условия, что у отчётов при значениях фильтров по умолчанию;
+// %1 — выражение дня для СУБД
+const char *const TimeCubeSql = R"(
+    SELECT %1 AS Day, invoices.BillingCountry, genres.GenreId, genres.Name,
+           SUM(invoice_items.Quantity), SUM(invoice_items.Quantity * invoice_items.UnitPrice)
+    FROM invoice_items
+    JOIN invoices ON invoice_items.InvoiceId = invoices.InvoiceId
+    LEFT JOIN tracks ON invoice_items.TrackId = tracks.TrackId
+    LEFT JOIN genres ON tracks.GenreId = genres.GenreId
+    WHERE invoices.InvoiceDate >= '0001-01-01' AND invoices.InvoiceDate < '9999-12-31'
+    GROUP BY Day, invoices.BillingCountry, tracks.GenreId, genres.GenreId, genres.Name
+    ORDER BY Day)";
+
+} // namespace
+
+const quint32 TimeCube::NoKey;
+
+bool TimeCube::load(QSqlDatabase &db, int fetchSize, QString *error)
+{
+    QHash<QString, quint32> countryCodes;
+    QHash<qint64, quint32> genreCodes;
+    QString sql = QString(TimeCubeSql).arg(Dialect::dayOf(Dialect::of(db), "invoices.InvoiceDate"));
+    QString loadError;
+    bool ok = ServerCursor::forEachRow(db, sql, fetchSize, [&](const QSqlQuery &query) {
+        QDate day = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+        if (!day.isValid()) {
+            return true;
+        }
+        qint32 julianDay = qint32(day.toJulianDay());
+        cellDay.append(julianDay);
+        cellWeek.append(julianDay - (day.dayOfWeek() - 1));
+        cellMonth.append(day.year() * 12 + day.month() - 1);
+        cellQuarter.append(day.year() * 4 + (day.month() - 1) / 3);
+        cellCountry.append(DictionaryCodes::internName(countryCodes, countryNames, query.value(1).toString()));
+        cellGenre.append(DictionaryCodes::internId(genreCodes, genreNames, query.value(2), query.value(3)));
+        cellQuantity.append(query.value(4).toLongLong());
+        cellRevenue.append(query.value(5).toDouble());
+        return true;
+    }, &loadError);
+    if (!ok && error) {
+        *error = loadError;
+    }
+    return ok;
+}
+
+QDate TimeCube::firstDay() const
+{
+    return cellDay.isEmpty() ? QDate() : QDate::fromJulianDay(cellDay.first());
+}
+
+QDate TimeCube::lastDay() const
+{
+    return cellDay.isEmpty() ? QDate() : QDate::fromJulianDay(cellDay.last());
+}
+
+const QVector<qint32> &TimeCube::keys(TimeGranularity granularity) const
+{
+    switch (granularity) {
+    case TimeGranularity::Day:
+        return cellDay;
+    case TimeGranularity::Week:
+        return cellWeek;
+    case TimeGranularity::Month:
+        return cellMonth;
+    case TimeGranularity::Quarter:
+        return cellQuarter;
+    }
+    return cellMonth;
+}
+
+QDate TimeCube::periodStart(TimeGranularity granularity, qint32 key)
+{
+    switch (granularity) {
+    case TimeGranularity::Day:
+    case TimeGranularity::Week:
+        return QDate::fromJulianDay(key);
+    case TimeGranularity::Month:
+        return QDate(key / 12, key % 12 + 1, 1);
+    case TimeGranularity::Quarter:
+        return QDate(key / 4, (key % 4) * 3 + 1, 1);
+    }
+    return QDate();
+}
+
+QString TimeCube::periodLabel(TimeGranularity granularity, const QDate &start)
+{
+    switch (granularity) {
+    case TimeGranularity::Day:
+        return start.toString("yyyy-MM-dd");
+    case TimeGranularity::Week: {
+        int year = 0;
+        int week = start.weekNumber(&year);
+        return QString("%1-W%2").arg(year).arg(week, 2, 10, QChar('0'));
+    }
+    case TimeGranularity::Month:
+        return start.toString("yyyy-MM"); // как strftime('%Y-%m') в отчёте
+    case TimeGranularity::Quarter:
+        return QString("%1-Q%2").arg(start.year()).arg((start.month() - 1) / 3 + 1);
+    }
+    return QString();
+}
+
+QVector<PeriodSales> TimeCube::run(TimeGranularity granularity, const QDate &from, const QDate &to,
+                                   const CrossFilter &filter) const
+{
+    QVector<PeriodSales> periods;
+
+    int country = filter.country.isEmpty() ? -1 : countryNames.indexOf(filter.country);
+    int genre = filter.genre.isEmpty() ? -1 : genreNames.indexOf(filter.genre);
+    if ((!filter.country.isEmpty() && country < 0) || (!filter.genre.isEmpty() && genre < 0)) {
+        return periods;
+    }
+
+    // Ячейки диапазона дат лежат подряд
+    int begin = int(std::lower_bound(cellDay.constBegin(), cellDay.constEnd(), qint32(from.toJulianDay()))
+                    - cellDay.constBegin());
+    int end = int(std::upper_bound(cellDay.constBegin(), cellDay.constEnd(), qint32(to.toJulianDay()))
+                  - cellDay.constBegin());
+
+    // Ключ периода не убывает вместе с днём: новый ключ — новый период
+    const QVector<qint32> &periodKeys = keys(granularity);
+    qint32 currentKey = 0;
+    for (int cell = begin; cell < end; ++cell) {
+        if ((country >= 0 && cellCountry[cell] != quint32(country))
+                || (genre >= 0 && cellGenre[cell] != quint32(genre))) {
+            continue;
+        }
+        if (periods.isEmpty() || periodKeys[cell] != currentKey) {
+            currentKey = periodKeys[cell];
+            QDate start = periodStart(granularity, currentKey);
+            periods.append({start, periodLabel(granularity, start), 0, 0.0});
+        }
+        periods.last().quantity += cellQuantity[cell];
+        periods.last().revenue += cellRevenue[cell];
+    }
+    return periods;
+}
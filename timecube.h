@@ -0,0 +1,69 @@
+#ifndef TIMECUBE_H
+#define TIMECUBE_H
+
+#include "dictionarycodes.h"
+#include "salescube.h"
+#include <QDate>
+#include <QMetaType>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVector>
+
+enum class TimeGranularity { Day, Week, Month, Quarter };
+
+// Продажи за один период: начало периода, подпись и суммы
+struct PeriodSales
+{
+    QDate start;
+    QString label;
+    qint64 quantity;
+    double revenue;
+};
+
+// Временной куб: продажи по дням x страна x жанр, ячейки отсортированы
+// по дню. Целочисленные ключи дня (юлианский день), недели (день её
+// понедельника), месяца и квартала считаются один раз при загрузке.
+// Диапазон дат — непрерывный отрезок ячеек (двоичный поиск), а периоды
+// идут по возрастанию, поэтому выборка — один проход без хеш-таблиц.
+// Жанры кодируются по GenreId, как в кубе продаж
+class TimeCube
+{
+public:
+    static const quint32 NoKey = DictionaryCodes::NoKey;
+
+    // fetchSize > 0 — на PostgreSQL ячейки читаются порциями через курсор
+    bool load(QSqlDatabase &db, int fetchSize = 0, QString *error = nullptr);
+
+    int cellCount() const { return cellDay.size(); }
+    QDate firstDay() const;
+    QDate lastDay() const;
+
+    // Продажи по периодам в границах [from, to] включительно
+    QVector<PeriodSales> run(TimeGranularity granularity, const QDate &from, const QDate &to,
+                             const CrossFilter &filter = CrossFilter()) const;
+
+    static QDate periodStart(TimeGranularity granularity, qint32 key);
+    static QString periodLabel(TimeGranularity granularity, const QDate &start);
+
+private:
+    const QVector<qint32> &keys(TimeGranularity granularity) const;
+
+    QStringList countryNames;
+    QStringList genreNames;
+
+    QVector<qint32> cellDay;
+    QVector<qint32> cellWeek;
+    QVector<qint32> cellMonth;   // год * 12 + месяц - 1
+    QVector<qint32> cellQuarter; // год * 4 + квартал - 1
+    QVector<quint32> cellCountry;
+    QVector<quint32> cellGenre;  // NoKey, если жанра нет в genres
+    QVector<qint64> cellQuantity;
+    QVector<double> cellRevenue;
+};
+
+typedef QSharedPointer<const TimeCube> TimeCubePtr;
+
+Q_DECLARE_METATYPE(TimeCubePtr)
+
+#endif // TIMECUBE_H
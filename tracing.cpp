@@ -0,0 +1,191 @@
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+namespace
+{
+
+// Около 56 МБ при заполнении (событие — 56 байт в 64-битной сборке);
+// старые события перезаписываются
+const int Capacity = 1 << 20;
+
+struct Buffer
+{
+    QMutex mutex;
+    QVector<Tracing::Event> events;
+    int next = 0;       // куда писать следующее событие
+    bool wrapped = false;
+};
+
+Buffer &buffer()
+{
+    static Buffer instance;
+    return instance;
+}
+
+QElapsedTimer &clock()
+{
+    static QElapsedTimer timer;
+    static bool started = (timer.start(), true);
+    Q_UNUSED(started);
+    return timer;
+}
+
+QString escaped(const char *text)
+{
+    QString value = QString::fromUtf8(text);
+    value.replace("\\", "\\\\");
+    value.replace("\"", "\\\"");
+    return value;
+}
+
+} // namespace
+
+QAtomicInt Tracing::active(0);
+
+void Tracing::setEnabled(bool enabled)
+{
+    clock();
+    active.store(enabled ? 1 : 0);
+}
+
+qint64 Tracing::now()
+{
+    return clock().nsecsElapsed() / 1000;
+}
+
+void Tracing::record(const Event &event)
+{
+    Event stored = event;
+    stored.thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    Buffer &target = buffer();
+    QMutexLocker locker(&target.mutex);
+    if (target.events.size() < Capacity) {
+        target.events.append(stored);
+        return;
+    }
+    target.events[target.next] = stored;
+    target.next = (target.next + 1) % Capacity;
+    target.wrapped = true;
+}
+
+void Tracing::recordCounter(const char *name, qint64 value)
+{
+    record({name, "counter", 'C', now(), 0, value, 0});
+}
+
+QVector<Tracing::Event> Tracing::events(qint64 since)
+{
+    Buffer &source = buffer();
+    QMutexLocker locker(&source.mutex);
+    QVector<Event> result;
+    int count = source.events.size();
+    int first = source.wrapped ? source.next : 0;
+    for (int i = 0; i < count; ++i) {
+        const Event &event = source.events[(first + i) % count];
+        if (event.start >= since) {
+            result.append(event);
+        }
+    }
+    return result;
+}
+
+void Tracing::clear()
+{
+    Buffer &target = buffer();
+    QMutexLocker locker(&target.mutex);
+    target.events.clear();
+    target.next = 0;
+    target.wrapped = false;
+}
+
+QString Tracing::summary(qint64 since)
+{
+    // Порядок — по первому появлению имени. Имена — строковые литералы,
+    // поэтому строка ищется по указателю; по тексту — только при первой
+    // встрече указателя (одинаковые литералы разных файлов сливаются)
+    QHash<const char *, int> indexByPointer;
+    QHash<QString, int> indexByName;
+    QStringList names;
+    QVector<qint64> values;
+    QVector<bool> spans;
+    for (const Event &event : events(since)) {
+        auto it = indexByPointer.constFind(event.name);
+        int index;
+        if (it != indexByPointer.constEnd()) {
+            index = it.value();
+        } else {
+            QString name = QString::fromUtf8(event.name);
+            index = indexByName.value(name, -1);
+            if (index < 0) {
+                index = names.size();
+                indexByName.insert(name, index);
+                names << name;
+                values << 0;
+                spans << (event.phase == 'X');
+            }
+            indexByPointer.insert(event.name, index);
+        }
+        if (event.phase == 'X') {
+            values[index] += event.duration;
+        } else {
+            values[index] = event.value;
+        }
+    }
+
+    QStringList parts;
+    for (int i = 0; i < names.size(); ++i) {
+        parts << (spans[i] ? QString("%1 %2 мс").arg(names[i]).arg(values[i] / 1000.0, 0, 'f', 1)
+                           : QString("%1 %2").arg(names[i]).arg(values[i]));
+    }
+    return parts.join(", ");
+}
+
+bool Tracing::exportChromeTrace(const QString &fileName, QString *error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    // JSON пишется потоком, без промежуточного QJsonDocument
+    qint64 pid = QCoreApplication::applicationPid();
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const Event &event : events()) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"" << escaped(event.name) << "\",\"cat\":\"" << escaped(event.category)
+            << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.start
+            << ",\"pid\":" << pid << ",\"tid\":" << quint64(event.thread);
+        if (event.phase == 'X') {
+            out << ",\"dur\":" << event.duration;
+        } else {
+            out << ",\"args\":{\"value\":" << event.value << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+    out.flush();
+
+    if (out.status() != QTextStream::Ok) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
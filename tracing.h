@@ -0,0 +1,85 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QAtomicInt>
+#include <QString>
+#include <QVector>
+
+// Лёгкая трассировка горячих путей: интервалы (Span) и счётчики с
+// отметками времени и потоком. Пока трассировка выключена, интервал и
+// счётчик стоят одной атомарной проверки. События хранятся в кольцевом
+// буфере и выгружаются в формате Chrome trace (chrome://tracing, Perfetto).
+// Имена и категории — строковые литералы, они не копируются
+namespace Tracing
+{
+    struct Event
+    {
+        const char *name;
+        const char *category;
+        char phase;        // 'X' — интервал, 'C' — счётчик
+        qint64 start;      // мкс от запуска
+        qint64 duration;   // мкс, для интервалов
+        qint64 value;      // для счётчиков
+        quintptr thread;
+    };
+
+    extern QAtomicInt active;
+
+    inline bool isEnabled() { return active.load() != 0; }
+    void setEnabled(bool enabled);
+
+    // Микросекунды от первого обращения к трассировке
+    qint64 now();
+
+    void record(const Event &event);
+    void recordCounter(const char *name, qint64 value);
+
+    inline void counter(const char *name, qint64 value)
+    {
+        if (isEnabled()) {
+            recordCounter(name, value);
+        }
+    }
+
+    // События начиная с момента since, по времени записи
+    QVector<Event> events(qint64 since = 0);
+    void clear();
+
+    // Интервалы с суммарной длительностью по имени и последние значения
+    // счётчиков, например «exec 12.3 мс, fetch 3.1 мс, rows 2240»
+    QString summary(qint64 since);
+
+    bool exportChromeTrace(const QString &fileName, QString *error = nullptr);
+
+    class Span
+    {
+    public:
+        explicit Span(const char *name, const char *category = "app")
+            : name(name)
+            , category(category)
+            , start(isEnabled() ? now() : -1)
+        {
+        }
+
+        ~Span()
+        {
+            if (start >= 0) {
+                record({name, category, 'X', start, now() - start, 0, 0});
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Span)
+
+        const char *name;
+        const char *category;
+        qint64 start;
+    };
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Tracing::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_SCOPE_CATEGORY(name, category) Tracing::Span TRACE_CONCAT(traceSpan, __LINE__)(name, category)
+
+#endif // TRACING_H
@@ -1,6 +1,7 @@
 #ifndef ZOOMABLEGRAPHICSVIEW_H
 #define ZOOMABLEGRAPHICSVIEW_H
 
+#include "tracing.h"
 #include <QGraphicsView>
 #include <QMouseEvent>
 #include <QWheelEvent>
@@ -16,9 +17,33 @@ public:
         setDragMode(QGraphicsView::NoDrag); // Перетаскивание будет обрабатываться вручную
         setTransformationAnchor(QGraphicsView::AnchorUnderMouse); // Масштабирование относительно курсора
         setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+
+        // Перерисовывается только изменившаяся область
+        setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
     }
 
+    // Для карты элементы сами восстанавливают состояние QPainter, а
+    // неизменный фон из тайлов хранится растром и при прокрутке не
+    // перерисовывается. Прочие сцены рисуются с сохранением состояния
+    // и без кэша фона
+    void setMapRendering(bool map)
+    {
+        setOptimizationFlag(QGraphicsView::DontSavePainterState, map);
+        setCacheMode(map ? QGraphicsView::CacheBackground : QGraphicsView::CacheNone);
+    }
+
+signals:
+    // Текущий масштаб вида: по нему сцена карты выбирает уровень кластеров
+    void scaleChanged(qreal scale);
+
 protected:
+    // Отрисовка видимой области, в трассе — интервалом на каждый кадр
+    void paintEvent(QPaintEvent *event) override
+    {
+        TRACE_SCOPE_CATEGORY("ZoomableGraphicsView::paint", "paint");
+        QGraphicsView::paintEvent(event);
+    }
+
     // Масштабирование колесом мыши
     void wheelEvent(QWheelEvent *event) override
     {
@@ -36,6 +61,8 @@ protected:
             isDragging = true;
             dragStartPosition = event->pos();
             setCursor(Qt::ClosedHandCursor); // Меняем курсор на "руку"
+            // Во время перетаскивания тайлы рисуются без сглаживания
+            setRenderHint(QPainter::SmoothPixmapTransform, false);
         }
         QGraphicsView::mousePressEvent(event);
     }
@@ -57,20 +84,26 @@ protected:
         if (event->button() == Qt::LeftButton) {
             isDragging = false;
             setCursor(Qt::ArrowCursor); // Возвращаем стандартный курсор
+            setRenderHint(QPainter::SmoothPixmapTransform, true);
+            viewport()->update();
         }
         QGraphicsView::mouseReleaseEvent(event);
     }
 
 private:
+    // Приближение до отдельных городов на карте
+    static constexpr qreal MaxScale = 32.0;
+
     qreal scaleFactor;
     bool isDragging;
     QPoint dragStartPosition;
 
     void zoomIn()
     {
-        if (scaleFactor <= 5.0) { // Ограничиваем максимальное приближение
+        if (scaleFactor <= MaxScale) { // Ограничиваем максимальное приближение
             scale(1.1, 1.1);
             scaleFactor *= 1.1;
+            emit scaleChanged(scaleFactor);
         }
     }
 
@@ -79,6 +112,7 @@ private:
         if (scaleFactor >= 1.0) { // Ограничиваем минимальное отдаление
             scale(1 / 1.1, 1 / 1.1);
             scaleFactor /= 1.1;
+            emit scaleChanged(scaleFactor);
         }
     }
 };